@@ -5,16 +5,71 @@
 
 #include "ban.h"
 
+#include "configmanager.h"
 #include "connection.h"
 #include "database.h"
 #include "databasetasks.h"
+#include "tools.h"
+
+namespace {
+
+	struct BanCacheEntry {
+		std::optional<IOBan::BanInfo> banInfo;
+		int64_t expiresAt;
+	};
+
+	constexpr size_t BAN_CACHE_SWEEP_SIZE = 1024;
+
+	std::mutex banCacheLock;
+	std::unordered_map<uint32_t, BanCacheEntry> accountBanCache;
+	std::unordered_map<std::string, BanCacheEntry> ipBanCache;
+
+	template<typename Key>
+	bool getCachedBan(const std::unordered_map<Key, BanCacheEntry>& cache, const Key& key, std::optional<IOBan::BanInfo>& banInfo) {
+		std::lock_guard<std::mutex> lockClass(banCacheLock);
+		auto it = cache.find(key);
+		if (it == cache.end() || it->second.expiresAt <= OTSYS_TIME()) {
+			return false;
+		}
+
+		// a ban that ran out while cached is looked up again so it gets moved to the history
+		const auto& cached = it->second.banInfo;
+		if (cached && cached->expiresAt != 0 && time(nullptr) > cached->expiresAt) {
+			return false;
+		}
+
+		banInfo = cached;
+		return true;
+	}
+
+	template<typename Key>
+	void setCachedBan(std::unordered_map<Key, BanCacheEntry>& cache, const Key& key, const std::optional<IOBan::BanInfo>& banInfo) {
+		const int64_t cacheTime = static_cast<int64_t>(getNumber(ConfigManager::LOGIN_CACHE_TIME)) * 1000;
+		if (cacheTime <= 0) {
+			return;
+		}
+
+		const int64_t now = OTSYS_TIME();
+
+		std::lock_guard<std::mutex> lockClass(banCacheLock);
+		if (cache.size() >= BAN_CACHE_SWEEP_SIZE) {
+			std::erase_if(cache, [now](const auto& it) { return it.second.expiresAt <= now; });
+		}
+		cache[key] = {banInfo, now + cacheTime};
+	}
+
+} // namespace
 
 namespace IOBan {
-	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId) {
-		Database& db = Database::getInstance();
+	const std::optional<BanInfo> getAccountBanInfo(Database& db, uint32_t accountId) {
+		std::optional<BanInfo> cachedBan;
+		if (getCachedBan(accountBanCache, accountId, cachedBan)) {
+			return cachedBan;
+		}
 
 		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, `banned_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans` WHERE `account_id` = {:d}", accountId));
 		if (!result) {
+			setCachedBan(accountBanCache, accountId, std::nullopt);
 			return std::nullopt;
 		}
 
@@ -35,24 +90,31 @@ namespace IOBan {
 		}
 	 
 		banInfo->bannedBy = result->getString("name");
+		setCachedBan(accountBanCache, accountId, banInfo);
 		return banInfo;
 	}
 
-	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP) {
+	const std::optional<BanInfo> getIpBanInfo(Database& db, const Connection::Address& clientIP) {
 		if (clientIP.is_unspecified()) {
 			return std::nullopt;
 		}
 
-		Database& db = Database::getInstance();
+		const std::string ip = clientIP.to_string();
+
+		std::optional<BanInfo> cachedBan;
+		if (getCachedBan(ipBanCache, ip, cachedBan)) {
+			return cachedBan;
+		}
 
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
+		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", ip));
 		if (!result) {
+			setCachedBan(ipBanCache, ip, std::nullopt);
 			return std::nullopt;
 		}
 
 		int64_t expiresAt = result->getNumber<int64_t>("expires_at");
 		if (expiresAt != 0 && time(nullptr) > expiresAt) {
-			g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
+			g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", ip));
 			return std::nullopt;
 		}
 
@@ -65,11 +127,50 @@ namespace IOBan {
 		}
 	 
 		banInfo->bannedBy = result->getString("name");
+		setCachedBan(ipBanCache, ip, banInfo);
 		return banInfo;
 	}
 
-	bool isPlayerNamelocked(uint32_t playerId) {
-		return Database::getInstance().storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get();
+	bool isPlayerNamelocked(Database& db, uint32_t playerId) {
+		return db.storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get();
+	}
+
+	bool addAccountBan(uint32_t accountId, std::string_view reason, time_t expiresAt, uint32_t bannedBy) {
+		bool added = Database::getInstance().executePrepared("INSERT INTO `account_bans` (`account_id`, `reason`, `banned_at`, `expires_at`, `banned_by`) VALUES (?, ?, ?, ?, ?)", {accountId, reason, time(nullptr), expiresAt, bannedBy});
+		clearBanCache(accountId);
+		return added;
+	}
+
+	bool removeAccountBan(uint32_t accountId) {
+		bool removed = Database::getInstance().executePrepared("DELETE FROM `account_bans` WHERE `account_id` = ?", {accountId});
+		clearBanCache(accountId);
+		return removed;
+	}
+
+	bool addIpBan(std::string_view ip, std::string_view reason, time_t expiresAt, uint32_t bannedBy) {
+		bool added = Database::getInstance().executePrepared("INSERT INTO `ip_bans` (`ip`, `reason`, `banned_at`, `expires_at`, `banned_by`) VALUES (INET6_ATON(?), ?, ?, ?, ?)", {ip, reason, time(nullptr), expiresAt, bannedBy});
+		std::lock_guard<std::mutex> lockClass(banCacheLock);
+		ipBanCache.erase(std::string{ip});
+		return added;
+	}
+
+	bool removeIpBan(std::string_view ip) {
+		bool removed = Database::getInstance().executePrepared("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON(?)", {ip});
+		std::lock_guard<std::mutex> lockClass(banCacheLock);
+		ipBanCache.erase(std::string{ip});
+		return removed;
+	}
+
+	void clearBanCache(uint32_t accountId/* = 0*/) {
+		std::lock_guard<std::mutex> lockClass(banCacheLock);
+		// the ips an account logs in from are not known here, a ban placed with the account ban may be on any of them
+		ipBanCache.clear();
+		if (accountId == 0) {
+			accountBanCache.clear();
+			return;
+		}
+
+		accountBanCache.erase(accountId);
 	}
 
 } // namespace IOBan
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 #include "connection.h"
 
+class Database;
+
 namespace IOBan {
 
 	struct BanInfo {
@@ -14,9 +16,18 @@ namespace IOBan {
 		time_t expiresAt;
 	};
 
-	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId);
-	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP);
-	bool isPlayerNamelocked(uint32_t playerId);
+	const std::optional<BanInfo> getAccountBanInfo(Database& db, uint32_t accountId);
+	const std::optional<BanInfo> getIpBanInfo(Database& db, const Connection::Address& clientIP);
+	bool isPlayerNamelocked(Database& db, uint32_t playerId);
+
+	// write the ban tables and drop the cached bans they change, so a ban applies to the next login
+	bool addAccountBan(uint32_t accountId, std::string_view reason, time_t expiresAt, uint32_t bannedBy);
+	bool removeAccountBan(uint32_t accountId);
+	bool addIpBan(std::string_view ip, std::string_view reason, time_t expiresAt, uint32_t bannedBy);
+	bool removeIpBan(std::string_view ip);
+
+	// drops the cached bans of an account and all cached ip bans, or every cached ban when accountId is 0
+	void clearBanCache(uint32_t accountId = 0);
 
 }; // namespace IOBan
 
@@ -25,12 +25,14 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream) {
 			}
 
 			if (guid != 0) {
-				std::string name = IOLoginData::getNameByGuid(guid);
-				if (!name.empty()) {
-					setSpecialDescription(name + " is sleeping there.");
-					g_game.setBedSleeper(this, guid);
-					sleeperGUID = guid;
-				}
+				callGame([this, guid]() {
+					std::string name = IOLoginData::getNameByGuid(guid);
+					if (!name.empty()) {
+						setSpecialDescription(name + " is sleeping there.");
+						g_game.setBedSleeper(this, guid);
+						sleeperGUID = guid;
+					}
+				});
 			}
 			return ATTR_READ_CONTINUE;
 		}
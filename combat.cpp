@@ -714,7 +714,7 @@ void Combat::doCombat(Creature* caster, const Position& position) const {
 
 			combatTileEffects(spectators, caster, tile, params);
 
-			if (CreatureVector* creatures = tile->getCreatures()) {
+			if (TileCreatureVector* creatures = tile->getCreatures()) {
 				const Creature* topCreature = tile->getTopCreature();
 				for (Creature* creature : *creatures) {
 					if (params.targetCasterOrTopMost) {
@@ -855,6 +855,85 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 	}
 }
 
+CombatBatch::CombatBatch(const SpectatorVec& spectators) : spectators(spectators) {}
+
+CombatBatch::~CombatBatch() {
+	flush();
+}
+
+void CombatBatch::getSpectators(SpectatorVec& result, const Position& centerPos, bool multifloor) const {
+	for (Creature* spectator : spectators) {
+		if (Map::isInSpectatorRange(centerPos, spectator->getPosition(), multifloor)) {
+			result.emplace_back(spectator);
+		}
+	}
+}
+
+void CombatBatch::addTextMessage(Player* player, const TextMessage& message) {
+	player->incrementReferenceCounter();
+	textMessages.emplace_back(player, message);
+}
+
+void CombatBatch::addCreatureHealth(Creature* creature) {
+	if (std::find(healthUpdates.begin(), healthUpdates.end(), creature) != healthUpdates.end()) {
+		return;
+	}
+
+	creature->incrementReferenceCounter();
+	healthUpdates.push_back(creature);
+}
+
+void CombatBatch::flush() {
+	// effects, texts and health follow each other as they would for a single target
+	if (!magicEffects.empty()) {
+		for (Creature* spectator : spectators) {
+			Player* player = spectator->getPlayer();
+			if (!player) {
+				continue;
+			}
+
+			const Position& spectatorPos = player->getPosition();
+			for (const auto& [pos, effect] : magicEffects) {
+				if (Map::isInSpectatorRange(pos, spectatorPos, true)) {
+					player->sendMagicEffect(pos, effect);
+				}
+			}
+		}
+	}
+
+	for (const auto& [player, message] : textMessages) {
+		if (!player->isRemoved()) {
+			player->sendTextMessage(message);
+		}
+	}
+
+	if (!healthUpdates.empty()) {
+		for (Creature* spectator : spectators) {
+			Player* player = spectator->getPlayer();
+			if (!player) {
+				continue;
+			}
+
+			const Position& spectatorPos = player->getPosition();
+			for (const Creature* creature : healthUpdates) {
+				if (Map::isInSpectatorRange(creature->getPosition(), spectatorPos, true)) {
+					player->sendCreatureHealth(creature);
+				}
+			}
+		}
+	}
+
+	magicEffects.clear();
+	for (const auto& it : textMessages) {
+		it.first->decrementReferenceCounter();
+	}
+	textMessages.clear();
+	for (Creature* creature : healthUpdates) {
+		creature->decrementReferenceCounter();
+	}
+	healthUpdates.clear();
+}
+
 void Combat::doAreaCombat(Creature* caster, const Position& position, const AreaCombat* area, CombatDamage& damage, const CombatParams& params) {
 	auto tiles = caster ? getCombatArea(caster->getPosition(), position, area) : getCombatArea(position, position, area);
 
@@ -900,7 +979,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 
 		combatTileEffects(spectators, caster, tile, params);
 
-		if (CreatureVector* creatures = tile->getCreatures()) {
+		if (TileCreatureVector* creatures = tile->getCreatures()) {
 			const Creature* topCreature = tile->getTopCreature();
 			for (Creature* creature : *creatures) {
 				if (params.targetCasterOrTopMost) {
@@ -928,6 +1007,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 	leechCombat.origin = ORIGIN_NONE;
 	leechCombat.leeched = true;
 
+	CombatBatch batch(spectators);
 	for (Creature* creature : toDamageCreatures) {
 		CombatDamage damageCopy = damage; // we cannot avoid copying here, because we don't know if it's player combat or not, so we can't modify the initial damage.
 		bool playerCombatReduced = false;
@@ -943,17 +1023,17 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 		if (damageCopy.critical) {
 			damageCopy.primary.value += playerCombatReduced ? criticalPrimary / 2 : criticalPrimary;
 			damageCopy.secondary.value += playerCombatReduced ? criticalSecondary / 2 : criticalSecondary;
-			g_game.addMagicEffect(creature->getPosition(), CONST_ME_CRITICAL_DAMAGE);
+			batch.addMagicEffect(creature->getPosition(), CONST_ME_CRITICAL_DAMAGE);
 		}
 
 		bool success = false;
 		if (damageCopy.primary.type != COMBAT_MANADRAIN) {
-			if (g_game.combatBlockHit(damageCopy, caster, creature, params.blockedByShield, params.blockedByArmor, params.itemId != 0, params.ignoreResistances)) {
+			if (g_game.combatBlockHit(damageCopy, caster, creature, params.blockedByShield, params.blockedByArmor, params.itemId != 0, params.ignoreResistances, &batch)) {
 				continue;
 			}
-			success = g_game.combatChangeHealth(caster, creature, damageCopy);
+			success = g_game.combatChangeHealth(caster, creature, damageCopy, &batch);
 		} else {
-			success = g_game.combatChangeMana(caster, creature, damageCopy);
+			success = g_game.combatChangeMana(caster, creature, damageCopy, &batch);
 		}
 
 		if (success) {
@@ -1008,6 +1088,8 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			params.targetCallback->onTargetCombat(caster, creature);
 		}
 	}
+
+	batch.flush();
 }
 
 //**********************************************************//
@@ -16,6 +16,7 @@ class SpectatorVec;
 class Tile;
 
 struct Position;
+struct TextMessage;
 
 //for luascript callback
 class ValueCallback final : public CallBack {
@@ -75,6 +76,35 @@ class AreaCombat {
 		bool hasExtArea = false;
 };
 
+// Shares the spectators of an area combat between all of its targets and
+// defers the magic effects, text messages and health updates they produce, so
+// that they are sent in a single pass once all targets were processed.
+class CombatBatch {
+	public:
+		explicit CombatBatch(const SpectatorVec& spectators);
+		~CombatBatch();
+
+		// non-copyable
+		CombatBatch(const CombatBatch&) = delete;
+		CombatBatch& operator=(const CombatBatch&) = delete;
+
+		void getSpectators(SpectatorVec& result, const Position& centerPos, bool multifloor) const;
+
+		void addMagicEffect(const Position& pos, uint8_t effect) {
+			magicEffects.emplace_back(pos, effect);
+		}
+		void addTextMessage(Player* player, const TextMessage& message);
+		void addCreatureHealth(Creature* creature);
+
+		void flush();
+
+	private:
+		const SpectatorVec& spectators;
+		std::vector<std::pair<Position, uint8_t>> magicEffects;
+		std::vector<std::pair<Player*, TextMessage>> textMessages;
+		std::vector<Creature*> healthUpdates;
+};
+
 class Combat {
 	public:
 		Combat() = default;
@@ -1174,6 +1174,69 @@ void ConditionDamage::serialize(PropWriteStream& propWriteStream) {
 	}
 }
 
+void ConditionDamage::serializeTemplate(PropWriteStream& propWriteStream) const {
+	propWriteStream.write<uint32_t>(getId());
+	propWriteStream.write<uint32_t>(conditionType);
+	propWriteStream.write<int32_t>(ticks);
+	propWriteStream.write<uint32_t>(subId);
+	propWriteStream.write<uint8_t>(isBuff);
+	propWriteStream.write<uint8_t>(aggressive);
+	// the end time of a template only tells whether its ticks were ever set
+	propWriteStream.write<uint8_t>(endTime != 0);
+
+	propWriteStream.write<int32_t>(maxDamage);
+	propWriteStream.write<int32_t>(minDamage);
+	propWriteStream.write<int32_t>(startDamage);
+	propWriteStream.write<int32_t>(periodDamage);
+	propWriteStream.write<int32_t>(periodDamageTick);
+	propWriteStream.write<int32_t>(tickInterval);
+	propWriteStream.write<int32_t>(initDamage);
+	propWriteStream.write<uint8_t>(forceUpdate);
+	propWriteStream.write<uint8_t>(delayed);
+	propWriteStream.write<uint8_t>(field);
+	propWriteStream.write<uint32_t>(owner);
+
+	propWriteStream.write<uint32_t>(damageList.size());
+	for (const IntervalInfo& intervalInfo : damageList) {
+		propWriteStream.write<IntervalInfo>(intervalInfo);
+	}
+}
+
+std::unique_ptr<ConditionDamage> ConditionDamage::unserializeTemplate(PropStream& propStream) {
+	uint32_t id, type, subId;
+	int32_t ticks;
+	uint8_t isBuff, aggressive, timed;
+	if (!propStream.read(id) || !propStream.read(type) || !propStream.read(ticks) || !propStream.read(subId) || !propStream.read(isBuff) || !propStream.read(aggressive) || !propStream.read(timed)) {
+		return nullptr;
+	}
+
+	auto condition = std::make_unique<ConditionDamage>(static_cast<ConditionId_t>(id), static_cast<ConditionType_t>(type), isBuff != 0, subId, aggressive != 0);
+	condition->ticks = ticks;
+	if (timed != 0) {
+		condition->setTicks(ticks);
+	}
+
+	uint8_t forceUpdate, delayed, field;
+	uint32_t intervalCount;
+	if (!propStream.read(condition->maxDamage) || !propStream.read(condition->minDamage) || !propStream.read(condition->startDamage) || !propStream.read(condition->periodDamage) ||
+			!propStream.read(condition->periodDamageTick) || !propStream.read(condition->tickInterval) || !propStream.read(condition->initDamage) ||
+			!propStream.read(forceUpdate) || !propStream.read(delayed) || !propStream.read(field) || !propStream.read(condition->owner) || !propStream.read(intervalCount)) {
+		return nullptr;
+	}
+
+	condition->forceUpdate = forceUpdate != 0;
+	condition->delayed = delayed != 0;
+	condition->field = field != 0;
+	for (uint32_t i = 0; i < intervalCount; ++i) {
+		IntervalInfo intervalInfo;
+		if (!propStream.read(intervalInfo)) {
+			return nullptr;
+		}
+		condition->damageList.push_back(intervalInfo);
+	}
+	return condition;
+}
+
 bool ConditionDamage::updateCondition(const Condition* addCondition) {
 	const ConditionDamage& conditionDamage = static_cast<const ConditionDamage&>(*addCondition);
 	if (conditionDamage.doForceUpdate()) {
@@ -273,6 +273,10 @@ class ConditionDamage final : public Condition {
 		void serialize(PropWriteStream& propWriteStream) override;
 		bool unserializeProp(ConditionAttr_t attr, PropStream& propStream) override;
 
+		// the whole state of a condition no creature has yet, such as the one of a field item type
+		void serializeTemplate(PropWriteStream& propWriteStream) const;
+		static std::unique_ptr<ConditionDamage> unserializeTemplate(PropStream& propStream);
+
 	private:
 		int32_t maxDamage = 0;
 		int32_t minDamage = 0;
@@ -176,6 +176,7 @@ bool ConfigManager::load() {
 		string[MYSQL_SOCK] = getGlobalString(L, "mysqlSock", "");
 
 		integer[SQL_PORT] = getGlobalNumber(L, "mysqlPort", 3306);
+		integer[DATABASE_WORKERS] = getGlobalNumber(L, "databaseWorkers", 2);
 
 		if (integer[GAME_PORT] == 0) {
 			integer[GAME_PORT] = getGlobalNumber(L, "gameProtocolPort", 7172);
@@ -227,6 +228,10 @@ bool ConfigManager::load() {
 	boolean[PLAYER_CONSOLE_LOGS] = getGlobalBoolean(L, "showPlayerLogInConsole", true);
 	boolean[CHECK_DUPLICATE_STORAGE_KEYS] = getGlobalBoolean(L, "checkDuplicateStorageKeys", false);
 	boolean[MONSTER_OVERSPAWN] = getGlobalBoolean(L, "monsterOverspawn", false);
+	boolean[ASYNC_SERVER_SAVE] = getGlobalBoolean(L, "asyncServerSave", false);
+	boolean[USE_WORLD_CACHE] = getGlobalBoolean(L, "useWorldCache", false);
+	boolean[CLEAN_SKIP_VISIBLE_TILES] = getGlobalBoolean(L, "cleanSkipVisibleTiles", false);
+	boolean[MAP_PAGING] = getGlobalBoolean(L, "mapPaging", false);
 
 	string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	string[SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -275,6 +280,10 @@ bool ConfigManager::load() {
 	integer[STAMINA_REGEN_PREMIUM] = getGlobalNumber(L, "timeToRegenMinutePremiumStamina", 10 * 60);
 	integer[PATHFINDING_INTERVAL] = getGlobalNumber(L, "pathfindingInterval", 200);
 	integer[PATHFINDING_DELAY] = getGlobalNumber(L, "pathfindingDelay", 300);
+	integer[PLAYER_SAVE_INTERVAL] = getGlobalNumber(L, "playerSaveInterval", 0);
+	integer[LOGIN_CACHE_TIME] = getGlobalNumber(L, "loginCacheTime", 0);
+	integer[CLEAN_TILES_PER_SLICE] = getGlobalNumber(L, "cleanTilesPerSlice", 500);
+	integer[MAP_REGION_IDLE_TIME] = getGlobalNumber(L, "mapRegionIdleTime", 600);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
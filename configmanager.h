@@ -46,6 +46,10 @@ namespace ConfigManager {
 		PLAYER_CONSOLE_LOGS,
 		CHECK_DUPLICATE_STORAGE_KEYS,
 		MONSTER_OVERSPAWN,
+		ASYNC_SERVER_SAVE,
+		USE_WORLD_CACHE,
+		CLEAN_SKIP_VISIBLE_TILES,
+		MAP_PAGING,
 
 		LAST_BOOLEAN_CONFIG /* this must be the last one */
 	};
@@ -117,6 +121,11 @@ namespace ConfigManager {
 		STAMINA_REGEN_PREMIUM,
 		PATHFINDING_INTERVAL,
 		PATHFINDING_DELAY,
+		PLAYER_SAVE_INTERVAL,
+		DATABASE_WORKERS,
+		LOGIN_CACHE_TIME,
+		CLEAN_TILES_PER_SLICE,
+		MAP_REGION_IDLE_TIME,
 
 		LAST_INTEGER_CONFIG /* this must be the last one */
 	};
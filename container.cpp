@@ -77,6 +77,26 @@ Container* Container::getParentContainer() {
 	return thing->getContainer();
 }
 
+Player* Container::getInventoryPlayer() {
+	// only containers reachable from an inventory slot count, not e.g. the store inbox
+	Item* item = this;
+	for (Cylinder* parent = getParent(); parent; parent = item->getParent()) {
+		if (Creature* creature = parent->getCreature()) {
+			Player* player = creature->getPlayer();
+			if (player && player->getThingIndex(item) != -1) {
+				return player;
+			}
+			return nullptr;
+		}
+
+		item = parent->getItem();
+		if (!item) {
+			return nullptr;
+		}
+	}
+	return nullptr;
+}
+
 std::string Container::getName(bool addArticle /* = false*/) const {
 	const ItemType& it = items[id];
 	return getNameDescription(it, this, -1, addArticle);
@@ -120,7 +140,8 @@ bool Container::unserializeItemNode(OTB::Loader& loader, const OTB::Node& node,
 		return false;
 	}
 
-	for (auto& itemNode : node.children) {
+	OTB::Node itemNode;
+	while (loader.nextChild(node, itemNode)) {
 		//load container items
 		if (itemNode.type != OTBM_ITEM) {
 			// unknown type
@@ -151,6 +172,12 @@ void Container::updateItemWeight(int32_t diff) {
 	totalWeight += diff;
 	if (Container* parentContainer = getParentContainer()) {
 		parentContainer->updateItemWeight(diff);
+	} else if (Cylinder* parent = getParent()) {
+		// the outermost container passes the change on to the player carrying it
+		Creature* creature = parent->getCreature();
+		if (Player* player = creature ? creature->getPlayer() : nullptr) {
+			player->addInventoryWeight(diff);
+		}
 	}
 }
 
@@ -213,6 +240,8 @@ bool Container::isHoldingItem(const Item* item) const {
 }
 
 void Container::onAddContainerItem(Item* item) {
+	notifyHouseChange();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -230,6 +259,8 @@ void Container::onAddContainerItem(Item* item) {
 }
 
 void Container::onUpdateContainerItem(uint32_t index, Item* oldItem, Item* newItem) {
+	notifyHouseChange();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -247,6 +278,8 @@ void Container::onUpdateContainerItem(uint32_t index, Item* oldItem, Item* newIt
 }
 
 void Container::onRemoveContainerItem(uint32_t index, Item* item) {
+	notifyHouseChange();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -519,6 +552,10 @@ void Container::addThing(int32_t index, Thing* thing) {
 	itemlist.push_front(item);
 	updateItemWeight(item->getWeight());
 
+	if (Player* player = getInventoryPlayer()) {
+		player->addItemTypeCount(item);
+	}
+
 	//send change to client
 	if (hasParent() && (getParent() != VirtualCylinder::virtualCylinder)) {
 		onAddContainerItem(item);
@@ -529,6 +566,10 @@ void Container::addItemBack(Item* item) {
 	addItem(item);
 	updateItemWeight(item->getWeight());
 
+	if (Player* player = getInventoryPlayer()) {
+		player->addItemTypeCount(item);
+	}
+
 	//send change to client
 	if (hasParent() && (getParent() != VirtualCylinder::virtualCylinder)) {
 		onAddContainerItem(item);
@@ -546,11 +587,20 @@ void Container::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getInventoryPlayer();
+	if (player) {
+		player->updateItemTypeCount(item->getID(), -static_cast<int32_t>(item->getItemCount()));
+	}
+
 	const int32_t oldWeight = item->getWeight();
 	item->setID(itemId);
 	item->setSubType(count);
 	updateItemWeight(-oldWeight + item->getWeight());
 
+	if (player) {
+		player->updateItemTypeCount(item->getID(), item->getItemCount());
+	}
+
 	//send change to client
 	if (hasParent()) {
 		onUpdateContainerItem(index, item, item);
@@ -576,6 +626,11 @@ void Container::replaceThing(uint32_t index, Thing* thing) {
 	item->setParent(this);
 	updateItemWeight(-static_cast<int32_t>(replacedItem->getWeight()) + item->getWeight());
 
+	if (Player* player = getInventoryPlayer()) {
+		player->removeItemTypeCount(replacedItem);
+		player->addItemTypeCount(item);
+	}
+
 	//send change to client
 	if (hasParent()) {
 		onUpdateContainerItem(index, replacedItem, item);
@@ -599,8 +654,13 @@ void Container::removeThing(Thing* thing, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getInventoryPlayer();
 	if (item->isStackable() && count != item->getItemCount()) {
 		uint8_t newCount = static_cast<uint8_t>(std::max<int32_t>(0, item->getItemCount() - count));
+		if (player) {
+			player->updateItemTypeCount(item->getID(), static_cast<int32_t>(newCount) - item->getItemCount());
+		}
+
 		const int32_t oldWeight = item->getWeight();
 		item->setItemCount(newCount);
 		updateItemWeight(-oldWeight + item->getWeight());
@@ -612,6 +672,10 @@ void Container::removeThing(Thing* thing, uint32_t count) {
 	} else {
 		updateItemWeight(-static_cast<int32_t>(item->getWeight()));
 
+		if (player) {
+			player->removeItemTypeCount(item);
+		}
+
 		//send change to client
 		if (hasParent()) {
 			onRemoveContainerItem(index, item);
@@ -709,6 +773,10 @@ void Container::internalRemoveThing(Thing* thing) {
 	if (cit == itemlist.end()) {
 		return;
 	}
+
+	if (Player* player = getInventoryPlayer()) {
+		player->removeItemTypeCount(*cit);
+	}
 	itemlist.erase(cit);
 }
 
@@ -725,6 +793,10 @@ void Container::internalAddThing(uint32_t, Thing* thing) {
 	item->setParent(this);
 	itemlist.push_front(item);
 	updateItemWeight(item->getWeight());
+
+	if (Player* player = getInventoryPlayer()) {
+		player->addItemTypeCount(item);
+	}
 }
 
 void Container::startDecaying() {
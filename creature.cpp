@@ -1407,6 +1407,10 @@ void Creature::setStorageValue(uint32_t key, std::optional<int32_t> value, bool
 	} else {
 		storageMap.erase(key);
 	}
+
+	if (oldValue != value) {
+		dirtyStorageKeys.insert(key);
+	}
 	events::creature::onUpdateStorage(this, key, value, oldValue, isSpawn);
 }
 
@@ -483,9 +483,18 @@ class Creature : virtual public Thing {
 
 		virtual void setStorageValue(uint32_t key, std::optional<int32_t> value, bool isSpawn = false);
 		virtual std::optional<int32_t> getStorageValue(uint32_t key) const;
-		decltype(auto) getStorageMap() const {
+		const auto& getStorageMap() const {
 			return storageMap;
 		}
+		const auto& getDirtyStorageKeys() const {
+			return dirtyStorageKeys;
+		}
+		void clearDirtyStorageKey(uint32_t key) {
+			dirtyStorageKeys.erase(key);
+		}
+		void clearDirtyStorageKeys() {
+			dirtyStorageKeys.clear();
+		}
 
 	protected:
 		struct CountBlock_t {
@@ -577,7 +586,9 @@ class Creature : virtual public Thing {
 		friend class LuaScriptInterface;
 
 	private:
-		std::map<uint32_t, int32_t> storageMap;
+		std::unordered_map<uint32_t, int32_t> storageMap;
+		// keys changed since the last successful save, removed keys included
+		std::unordered_set<uint32_t> dirtyStorageKeys;
 };
 
 #endif // FS_CREATURE_H
\ No newline at end of file
@@ -59,25 +59,32 @@ static bool isLostConnectionError(const unsigned error) {
 	return error == CR_SERVER_LOST || error == CR_SERVER_GONE_ERROR || error == CR_CONN_HOST_ERROR || error == 1053 /*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
 }
 
-static bool executeQuery(detail::Mysql_ptr& handle, std::string_view query, const bool retryIfLostConnection) {
+bool Database::sendQuery(std::string_view query, const bool retryIfLostConnection) {
 	while (mysql_real_query(handle.get(), query.data(), query.length()) != 0) {
 		std::cout << "[Error - mysql_real_query] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_error(handle.get()) << std::endl;
 		const unsigned error = mysql_errno(handle.get());
 		if (!isLostConnectionError(error) || !retryIfLostConnection) {
 			return false;
 		}
-		handle = connectToDatabase(true);
+		reconnect();
 	}
 
 	return true;
 }
 
+void Database::reconnect() {
+	// statements belong to the connection they were prepared on
+	preparedStatements.clear();
+	handle = connectToDatabase(true);
+}
+
 bool Database::connect() {
 	auto newHandle = connectToDatabase(false);
 	if (!newHandle) {
 		return false;
 	}
 
+	preparedStatements.clear();
 	handle = std::move(newHandle);
 	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
 	if (result) {
@@ -117,7 +124,7 @@ bool Database::commit() {
 
 bool Database::executeQuery(const std::string& query) {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
-	auto result = ::executeQuery(handle, query, retryQueries);
+	auto result = sendQuery(query, retryQueries);
 
 	// executeQuery can be called with command that produces result (e.g. SELECT)
 	// we have to store that result, even though we do not need it, otherwise handle will get blocked
@@ -127,11 +134,177 @@ bool Database::executeQuery(const std::string& query) {
 	return result;
 }
 
+bool Database::executeTransaction(const std::vector<std::string>& statements) {
+	DBTransaction transaction(*this);
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	for (const std::string& statement : statements) {
+		if (!executeQuery(statement)) {
+			return false;
+		}
+	}
+
+	return transaction.commit();
+}
+
+MYSQL_STMT* Database::executeStatement(std::string_view query, std::initializer_list<DBParam> params) {
+	while (true) {
+		MYSQL_STMT* stmt;
+		unsigned error;
+		if (auto it = preparedStatements.find(query); it != preparedStatements.end()) {
+			stmt = it->second.get();
+		} else {
+			detail::MysqlStmt_ptr newStmt{mysql_stmt_init(handle.get())};
+			if (!newStmt) {
+				std::cout << "[Error - mysql_stmt_init] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_error(handle.get()) << std::endl;
+				return nullptr;
+			}
+
+			if (mysql_stmt_prepare(newStmt.get(), query.data(), query.length()) != 0) {
+				std::cout << "[Error - mysql_stmt_prepare] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(newStmt.get()) << std::endl;
+				error = mysql_stmt_errno(newStmt.get());
+				if (!isLostConnectionError(error) || !retryQueries) {
+					return nullptr;
+				}
+				reconnect();
+				continue;
+			}
+
+			if (mysql_stmt_param_count(newStmt.get()) != params.size()) {
+				std::cout << "[Error - Database::executeStatement] Query: " << query.substr(0, 256) << std::endl << "Message: expected " << mysql_stmt_param_count(newStmt.get()) << " parameters, got " << params.size() << std::endl;
+				return nullptr;
+			}
+
+			stmt = preparedStatements.emplace(query, std::move(newStmt)).first->second.get();
+		}
+
+		std::vector<MYSQL_BIND> binds(params.size());
+		auto bind = binds.begin();
+		for (const DBParam& param : params) {
+			param.bind(*bind++);
+		}
+
+		if ((binds.empty() || !mysql_stmt_bind_param(stmt, binds.data())) && mysql_stmt_execute(stmt) == 0) {
+			return stmt;
+		}
+
+		std::cout << "[Error - mysql_stmt_execute] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt) << std::endl;
+		error = mysql_stmt_errno(stmt);
+		if (!isLostConnectionError(error) || !retryQueries) {
+			return nullptr;
+		}
+		reconnect();
+	}
+}
+
+bool Database::executePrepared(std::string_view query, std::initializer_list<DBParam> params/* = {}*/) {
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+	MYSQL_STMT* stmt = executeStatement(query, params);
+	if (!stmt) {
+		return false;
+	}
+
+	mysql_stmt_free_result(stmt);
+	return true;
+}
+
+DBResult_ptr Database::storePrepared(std::string_view query, std::initializer_list<DBParam> params/* = {}*/) {
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+	MYSQL_STMT* stmt = executeStatement(query, params);
+	if (!stmt) {
+		return nullptr;
+	}
+
+	detail::MysqlResult_ptr metadata{mysql_stmt_result_metadata(stmt)};
+	if (!metadata || mysql_stmt_store_result(stmt) != 0) {
+		std::cout << "[Error - mysql_stmt_store_result] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt) << std::endl;
+		mysql_stmt_free_result(stmt);
+		return nullptr;
+	}
+
+	// numeric columns are fetched into native buffers, variable-length columns by their length after the fetch of a row
+	using NullFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+	const unsigned int columns = mysql_num_fields(metadata.get());
+	const MYSQL_FIELD* fields = mysql_fetch_fields(metadata.get());
+	std::vector<MYSQL_BIND> binds(columns);
+	std::vector<unsigned long> lengths(columns);
+	std::vector<int64_t> integers(columns);
+	std::vector<double> reals(columns);
+	auto nulls = std::make_unique<NullFlag[]>(columns);
+	for (unsigned int i = 0; i < columns; ++i) {
+		switch (fields[i].type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				binds[i].buffer_type = MYSQL_TYPE_LONGLONG;
+				binds[i].buffer = &integers[i];
+				binds[i].is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+				break;
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				binds[i].buffer_type = MYSQL_TYPE_DOUBLE;
+				binds[i].buffer = &reals[i];
+				break;
+
+			default:
+				binds[i].buffer_type = MYSQL_TYPE_STRING;
+				break;
+		}
+		binds[i].length = &lengths[i];
+		binds[i].is_null = &nulls[i];
+	}
+
+	std::vector<DBResult::PreparedValue> values;
+	if (columns != 0 && !mysql_stmt_bind_result(stmt, binds.data())) {
+		int status;
+		while ((status = mysql_stmt_fetch(stmt)) == 0 || status == MYSQL_DATA_TRUNCATED) {
+			for (unsigned int i = 0; i < columns; ++i) {
+				if (nulls[i]) {
+					values.emplace_back(nullptr);
+				} else if (binds[i].buffer_type == MYSQL_TYPE_DOUBLE) {
+					values.emplace_back(reals[i]);
+				} else if (binds[i].buffer_type == MYSQL_TYPE_LONGLONG) {
+					if (binds[i].is_unsigned) {
+						values.emplace_back(static_cast<uint64_t>(integers[i]));
+					} else {
+						values.emplace_back(integers[i]);
+					}
+				} else {
+					std::string& value = std::get<std::string>(values.emplace_back(std::in_place_type<std::string>, lengths[i], '\0'));
+					if (lengths[i] != 0) {
+						MYSQL_BIND column{};
+						column.buffer_type = MYSQL_TYPE_STRING;
+						column.buffer = value.data();
+						column.buffer_length = lengths[i];
+						if (mysql_stmt_fetch_column(stmt, &column, i, 0) != 0) {
+							std::cout << "[Error - mysql_stmt_fetch_column] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt) << std::endl;
+							mysql_stmt_free_result(stmt);
+							return nullptr;
+						}
+					}
+				}
+			}
+		}
+	}
+	mysql_stmt_free_result(stmt);
+
+	if (values.empty()) {
+		return nullptr;
+	}
+	return std::make_shared<DBResult>(std::move(metadata), std::move(values));
+}
+
 DBResult_ptr Database::storeQuery(std::string_view query) {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
 
 	retry:
-	if (!::executeQuery(handle, query, retryQueries) && !retryQueries) {
+	if (!sendQuery(query, retryQueries) && !retryQueries) {
 		return nullptr;
 	}
 
@@ -182,38 +355,132 @@ DBResult::DBResult(detail::MysqlResult_ptr&& res) : handle {std::move(res)} {
 		listNames[field->name] = i++;
 		field = mysql_fetch_field(handle.get());
 	}
+	columns = i;
 
 	row = mysql_fetch_row(handle.get());
 }
 
-std::string_view DBResult::getString(std::string_view column) const {
+DBResult::DBResult(detail::MysqlResult_ptr&& metadata, std::vector<PreparedValue>&& values) :
+	handle{std::move(metadata)}, preparedValues{std::move(values)}, prepared{true} {
+	size_t i = 0;
+
+	MYSQL_FIELD* field = mysql_fetch_field(handle.get());
+	while (field) {
+		listNames[field->name] = i++;
+		field = mysql_fetch_field(handle.get());
+	}
+	columns = i;
+
+	preparedTexts.resize(i);
+}
+
+size_t DBResult::getColumnIndex(std::string_view column) const {
 	auto it = listNames.find(column);
 	if (it == listNames.end()) {
+		return npos;
+	}
+	return it->second;
+}
+
+std::string_view DBResult::getString(std::string_view column) const {
+	size_t index = getColumnIndex(column);
+	if (index == npos) {
 		std::cout << "[Error - DBResult::getString] Column '" << column << "' does not exist in result set." << std::endl;
 		return {};
 	}
+	return getString(index);
+}
+
+std::string_view DBResult::getString(size_t index) const {
+	if (index >= columns || !hasNext()) {
+		return {};
+	}
+
+	if (prepared) {
+		const PreparedValue& value = preparedValues[preparedIndex * columns + index];
+		if (auto string = std::get_if<std::string>(&value)) {
+			return *string;
+		}
+
+		// numeric cells are only turned into text when read as one
+		std::string& text = preparedTexts[index];
+		std::visit([&text](const auto& number) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(number)>, std::nullptr_t>) {
+				text.clear();
+			} else if constexpr (!std::is_same_v<std::decay_t<decltype(number)>, std::string>) {
+				text = fmt::format("{}", number);
+			}
+		}, value);
+		return text;
+	}
 
-	if (!row[it->second]) {
+	if (!row[index]) {
 		return {};
 	}
 
-	auto size = mysql_fetch_lengths(handle.get())[it->second];
-	return {row[it->second], size};
+	if (!lengths) {
+		lengths = mysql_fetch_lengths(handle.get());
+	}
+	return {row[index], lengths[index]};
 }
 
 bool DBResult::hasNext() const {
+	if (prepared) {
+		return columns != 0 && preparedIndex * columns < preparedValues.size();
+	}
 	return row;
 }
 
 bool DBResult::next() {
+	if (prepared) {
+		++preparedIndex;
+		return hasNext();
+	}
+
 	row = mysql_fetch_row(handle.get());
+	lengths = nullptr;
 	return row;
 }
 
+void DBParam::bind(MYSQL_BIND& bind) const {
+	if (auto number = std::get_if<int64_t>(&value)) {
+		bind.buffer_type = MYSQL_TYPE_LONGLONG;
+		bind.buffer = const_cast<int64_t*>(number);
+	} else if (auto unsignedNumber = std::get_if<uint64_t>(&value)) {
+		bind.buffer_type = MYSQL_TYPE_LONGLONG;
+		bind.buffer = const_cast<uint64_t*>(unsignedNumber);
+		bind.is_unsigned = true;
+	} else if (auto decimal = std::get_if<double>(&value)) {
+		bind.buffer_type = MYSQL_TYPE_DOUBLE;
+		bind.buffer = const_cast<double*>(decimal);
+	} else if (auto string = std::get_if<std::string_view>(&value)) {
+		bind.buffer_type = MYSQL_TYPE_STRING;
+		bind.buffer = const_cast<char*>(string->data());
+		bind.buffer_length = string->size();
+	} else {
+		bind.buffer_type = MYSQL_TYPE_NULL;
+	}
+}
+
 DBInsert::DBInsert(std::string query) : query(std::move(query)) {
 	this->length = this->query.length();
 }
 
+DBInsert::DBInsert(std::string query, std::vector<std::string>& statements) : query(std::move(query)), statements(&statements) {
+	this->length = this->query.length();
+}
+
+void DBInsert::upsert(const std::vector<std::string_view>& columns) {
+	upsertQuery = " ON DUPLICATE KEY UPDATE ";
+	for (size_t i = 0; i < columns.size(); ++i) {
+		if (i != 0) {
+			upsertQuery.push_back(',');
+		}
+		upsertQuery.append(fmt::format("`{0:s}` = VALUES(`{0:s}`)", columns[i]));
+	}
+	length = query.length() + upsertQuery.length();
+}
+
 bool DBInsert::addRow(const std::string& row) {
 	// adds new row to buffer
 	const size_t rowLength = row.length();
@@ -248,9 +515,14 @@ bool DBInsert::execute() {
 		return true;
 	}
 
-	// executes buffer
-	bool res = Database::getInstance().executeQuery(query + values);
+	bool res = true;
+	if (statements) {
+		statements->push_back(query + values + upsertQuery);
+	} else {
+		// executes buffer
+		res = Database::getInstance().executeQuery(query + values + upsertQuery);
+	}
 	values.clear();
-	length = query.length();
+	length = query.length() + upsertQuery.length();
 	return res;
 }
\ No newline at end of file
@@ -15,13 +15,42 @@ namespace detail {
 	struct MysqlDeleter{
 		void operator()(MYSQL* handle) const { mysql_close(handle); }
 		void operator()(MYSQL_RES* handle) const { mysql_free_result(handle); }
+		void operator()(MYSQL_STMT* handle) const { mysql_stmt_close(handle); }
 	};
 
 	using Mysql_ptr = std::unique_ptr<MYSQL, MysqlDeleter>;
 	using MysqlResult_ptr = std::unique_ptr<MYSQL_RES, MysqlDeleter>;
+	using MysqlStmt_ptr = std::unique_ptr<MYSQL_STMT, MysqlDeleter>;
 
 } // namespace detail
 
+/**
+* Value bound to a placeholder of a prepared statement.
+*/
+class DBParam {
+	public:
+		template<typename T> requires std::is_integral_v<T>
+		DBParam(T value) {
+			if constexpr (std::is_signed_v<T>) {
+				this->value = static_cast<int64_t>(value);
+			} else {
+				this->value = static_cast<uint64_t>(value);
+			}
+		}
+		DBParam(double value) : value(value) {}
+		DBParam(std::string_view value) : value(value) {}
+		DBParam(const std::string& value) : value(std::string_view{value}) {}
+		DBParam(const char* value) : value(std::string_view{value}) {}
+		DBParam(std::nullptr_t) : value(nullptr) {}
+
+	private:
+		void bind(MYSQL_BIND& bind) const;
+
+		std::variant<std::nullptr_t, int64_t, uint64_t, double, std::string_view> value;
+
+	friend class Database;
+};
+
 class Database {
 	public:
 		/**
@@ -60,6 +89,34 @@ class Database {
 		 */
 		DBResult_ptr storeQuery(std::string_view query);
 
+		/**
+		 * Executes statements in a single transaction.
+		 *
+		 * @param statements commands serialized beforehand, e.g. by DBInsert
+		 * @return true on success, false on error (nothing is committed)
+		 */
+		bool executeTransaction(const std::vector<std::string>& statements);
+
+		/**
+		 * Executes prepared command.
+		 *
+		 * The statement is prepared once per connection and reused, the parameters are bound instead of escaped.
+		 *
+		 * @param query command with ? placeholders
+		 * @param params values for the placeholders
+		 * @return true on success, false on error
+		 */
+		bool executePrepared(std::string_view query, std::initializer_list<DBParam> params = {});
+
+		/**
+		 * Queries database with a prepared statement.
+		 *
+		 * @param query query with ? placeholders
+		 * @param params values for the placeholders
+		 * @return results object (nullptr on error or without rows)
+		 */
+		DBResult_ptr storePrepared(std::string_view query, std::initializer_list<DBParam> params = {});
+
 		/**
 		 * Escapes string for query.
 		 *
@@ -117,7 +174,13 @@ class Database {
 		bool rollback();
 		bool commit();
 
+		bool sendQuery(std::string_view query, bool retryIfLostConnection);
+		void reconnect();
+		MYSQL_STMT* executeStatement(std::string_view query, std::initializer_list<DBParam> params);
+
 		detail::Mysql_ptr handle = nullptr;
+		// statements prepared on the current connection handle, keyed by query, cleared whenever the handle is replaced
+		std::map<std::string, detail::MysqlStmt_ptr, std::less<>> preparedStatements;
 		std::recursive_mutex databaseLock;
 		uint64_t maxPacketSize = 1048576;
 		// Do not retry queries if we are in the middle of a transaction
@@ -128,37 +191,100 @@ class Database {
 
 class DBResult {
 	public:
+		// cell of a prepared statement row, numeric columns keep the type they were fetched as
+		using PreparedValue = std::variant<std::nullptr_t, int64_t, uint64_t, double, std::string>;
+
 		explicit DBResult(detail::MysqlResult_ptr&& res);
+		DBResult(detail::MysqlResult_ptr&& metadata, std::vector<PreparedValue>&& values);
 
 		// non-copyable
 		DBResult(const DBResult&) = delete;
 		DBResult& operator=(const DBResult&) = delete;
 
+		static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+		/**
+		 * Resolves a column once so that loops over many rows can read it by index.
+		 *
+		 * @return column index, npos if the column is not in the result set
+		 */
+		size_t getColumnIndex(std::string_view column) const;
+
 		template<typename T>
 		T getNumber(std::string_view column) const {
-			auto it = listNames.find(column);
-			if (it == listNames.end()) {
+			size_t index = getColumnIndex(column);
+			if (index == npos) {
 				std::cout << "[Error - DBResult::getNumber] Column '" << column << "' doesn't exist in the result set" << std::endl;
 				return {};
 			}
+			return getNumber<T>(index);
+		}
 
-			if (!row[it->second]) {
+		template<typename T>
+		T getNumber(size_t index) const {
+			if (index >= columns || !hasNext()) {
 				return {};
 			}
 
-			return pugi::cast<T>(row[it->second]);
+			if (prepared) {
+				return std::visit([](const auto& value) -> T {
+					using Value = std::decay_t<decltype(value)>;
+					if constexpr (std::is_same_v<Value, std::nullptr_t>) {
+						return {};
+					} else if constexpr (std::is_same_v<Value, std::string>) {
+						return parseNumber<T>(value);
+					} else if constexpr (std::is_floating_point_v<Value> && !std::is_floating_point_v<T>) {
+						return static_cast<T>(static_cast<int64_t>(value));
+					} else {
+						return static_cast<T>(value);
+					}
+				}, preparedValues[preparedIndex * columns + index]);
+			}
+
+			if (!row[index]) {
+				return {};
+			}
+			return parseNumber<T>(getString(index));
 		}
 
 		std::string_view getString(std::string_view column) const;
+		std::string_view getString(size_t index) const;
 
 		bool hasNext() const;
 		bool next();
 
 	private:
+		template<typename T>
+		static T parseNumber(std::string_view value) {
+			if constexpr (std::is_floating_point_v<T>) {
+				T number{};
+				std::from_chars(value.data(), value.data() + value.size(), number);
+				return number;
+			} else if (!value.empty() && value.front() == '-') {
+				int64_t number = 0;
+				std::from_chars(value.data(), value.data() + value.size(), number);
+				return static_cast<T>(number);
+			} else {
+				uint64_t number = 0;
+				std::from_chars(value.data(), value.data() + value.size(), number);
+				return static_cast<T>(number);
+			}
+		}
+
 		detail::MysqlResult_ptr handle;
-		MYSQL_ROW row;
+		MYSQL_ROW row = nullptr;
 
 		std::map<std::string_view, size_t> listNames;
+		size_t columns = 0;
+		// lengths of the current row, fetched on first use
+		mutable unsigned long* lengths = nullptr;
+
+		// cells of a prepared statement, row after row
+		std::vector<PreparedValue> preparedValues;
+		// text of the numeric cells of the current row that were read as strings, one per column
+		mutable std::vector<std::string> preparedTexts;
+		size_t preparedIndex = 0;
+		bool prepared = false;
 
 	friend class Database;
 };
@@ -169,6 +295,9 @@ class DBResult {
 class DBInsert {
 	public:
 		explicit DBInsert(std::string query);
+		// collects the statements instead of executing them
+		DBInsert(std::string query, std::vector<std::string>& statements);
+		void upsert(const std::vector<std::string_view>& columns);
 		bool addRow(const std::string& row);
 		bool addRow(std::ostringstream& row);
 		bool execute();
@@ -176,16 +305,19 @@ class DBInsert {
 	private:
 		std::string query;
 		std::string values;
+		std::string upsertQuery;
+		std::vector<std::string>* statements = nullptr;
 		size_t length;
 };
 
 class DBTransaction {
 	public:
-		constexpr DBTransaction() = default;
+		DBTransaction() : db(Database::getInstance()) {}
+		explicit DBTransaction(Database& db) : db(db) {}
 
 		~DBTransaction() {
 			if (state == STATE_START) {
-				Database::getInstance().rollback();
+				db.rollback();
 			}
 		}
 
@@ -195,7 +327,7 @@ class DBTransaction {
 
 		bool begin() {
 			state = STATE_START;
-			return Database::getInstance().beginTransaction();
+			return db.beginTransaction();
 		}
 
 		bool commit() {
@@ -204,7 +336,7 @@ class DBTransaction {
 			}
 
 			state = STATE_COMMIT;
-			return Database::getInstance().commit();
+			return db.commit();
 		}
 
 	private:
@@ -214,6 +346,7 @@ class DBTransaction {
 			STATE_COMMIT,
 		};
 
+		Database& db;
 		TransactionStates_t state = STATE_NO_START;
 };
 
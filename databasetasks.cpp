@@ -5,40 +5,132 @@
 
 #include "databasetasks.h"
 
+#include "configmanager.h"
 #include "tasks.h"
+#include "tools.h"
 
 extern Dispatcher g_dispatcher;
 
-void DatabaseTasks::start() {
-	db.connect();
+namespace {
+
+std::string_view getInsertPrefix(const DatabaseTask& task) {
+	// only inserts that opted in can be merged, everything up to the first row has to match
+	if (!task.batched || !task.query.starts_with("INSERT INTO ") || !task.query.ends_with(')')) {
+		return {};
+	}
+
+	size_t pos = task.query.find(" VALUES (");
+	if (pos == std::string::npos || task.query.find(" ON DUPLICATE KEY ", pos) != std::string::npos) {
+		return {};
+	}
+	return std::string_view(task.query).substr(0, pos + 8);
+}
+
+}
+
+bool DatabaseTasks::start() {
+	int32_t workerCount = std::max<int32_t>(1, getNumber(ConfigManager::DATABASE_WORKERS));
+	for (int32_t i = 0; i < workerCount; ++i) {
+		if (!databases.emplace_back(std::make_unique<Database>())->connect()) {
+			databases.clear();
+			return false;
+		}
+	}
+
 	ThreadHolder::start();
+	for (size_t i = 1; i < databases.size(); ++i) {
+		workers.emplace_back(&DatabaseTasks::workerMain, this, std::ref(*databases[i]));
+	}
+	return true;
 }
 
 void DatabaseTasks::threadMain() {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
-			taskSignal.wait(taskLockUnique);
+	workerMain(*databases.front());
+}
+
+void DatabaseTasks::workerMain(Database& db) {
+	std::optional<DatabaseTask> task;
+	while ((task = takeTask())) {
+		int64_t start = OTSYS_TIME();
+		runTask(db, *task);
+		int64_t runTime = OTSYS_TIME() - start;
+
+		std::unique_lock<std::mutex> taskLockUnique(taskLock);
+		if (task->key != DATABASE_TASK_UNORDERED) {
+			runningKeys.erase(task->key);
+		}
+		--runningTasks;
+
+		++stats.executed;
+		stats.totalWait += start - task->queuedAt;
+		stats.totalRun += runTime;
+		stats.maxRun = std::max(stats.maxRun, runTime);
+
+		taskLockUnique.unlock();
+
+		// the finished key may unblock tasks queued behind it, or the flush of that key
+		taskSignal.notify_all();
+		flushSignal.notify_all();
+	}
+}
+
+std::optional<DatabaseTask> DatabaseTasks::takeTask() {
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (true) {
+		for (auto it = tasks.begin(); it != tasks.end(); ++it) {
+			// the first queued task of a key that is not running is the next one in its order
+			if (it->key != DATABASE_TASK_UNORDERED && runningKeys.contains(it->key)) {
+				continue;
+			}
+
+			DatabaseTask task = std::move(*it);
+			batchInserts(tasks.erase(it), task);
+
+			if (task.key != DATABASE_TASK_UNORDERED) {
+				runningKeys.insert(task.key);
+			}
+			++runningTasks;
+			return task;
 		}
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
-		} else {
-			taskLockUnique.unlock();
+		if (getState() == THREAD_STATE_TERMINATED && tasks.empty()) {
+			return std::nullopt;
 		}
+		taskSignal.wait(taskLockUnique);
 	}
 }
 
-void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/) {
+void DatabaseTasks::batchInserts(std::list<DatabaseTask>::iterator it, DatabaseTask& task) {
+	const std::string prefix{getInsertPrefix(task)};
+	if (prefix.empty()) {
+		return;
+	}
+
+	// later inserts of the same key into the same columns are appended as additional rows
+	const uint64_t maxPacketSize = databases.front()->getMaxPacketSize();
+	while (it != tasks.end()) {
+		if (it->key != task.key) {
+			++it;
+			continue;
+		}
+
+		if (getInsertPrefix(*it) != prefix || task.query.size() + it->query.size() - prefix.size() + 1 >= maxPacketSize) {
+			break;
+		}
+
+		task.query.push_back(',');
+		task.query.append(it->query, prefix.size());
+		it = tasks.erase(it);
+		++stats.batched;
+	}
+}
+
+void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/, DatabaseTaskKey key/* = DATABASE_TASK_DEFAULT*/) {
 	bool signal = false;
 	taskLock.lock();
 	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
+		signal = true;
+		tasks.emplace_back(std::move(query), std::move(callback), store, key).queuedAt = OTSYS_TIME();
 	}
 	taskLock.unlock();
 
@@ -47,7 +139,49 @@ void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr,
 	}
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task) {
+void DatabaseTasks::addTask(std::function<void(Database&)> job, DatabaseTaskKey key/* = DATABASE_TASK_DEFAULT*/) {
+	bool signal = false;
+	taskLock.lock();
+	if (getState() == THREAD_STATE_RUNNING) {
+		signal = true;
+		tasks.emplace_back(std::move(job), key).queuedAt = OTSYS_TIME();
+	}
+	taskLock.unlock();
+
+	if (signal) {
+		taskSignal.notify_one();
+	}
+}
+
+void DatabaseTasks::addBatchedInsert(std::string query, DatabaseTaskKey key) {
+	bool signal = false;
+	taskLock.lock();
+	if (getState() == THREAD_STATE_RUNNING) {
+		signal = true;
+		DatabaseTask& task = tasks.emplace_back(std::move(query), nullptr, false, key);
+		task.queuedAt = OTSYS_TIME();
+		task.batched = true;
+	}
+	taskLock.unlock();
+
+	if (signal) {
+		taskSignal.notify_one();
+	}
+}
+
+DatabaseTaskStats DatabaseTasks::getStats() {
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	DatabaseTaskStats result = stats;
+	result.queued = tasks.size();
+	return result;
+}
+
+void DatabaseTasks::runTask(Database& db, const DatabaseTask& task) {
+	if (task.job) {
+		task.job(db);
+		return;
+	}
+
 	bool success;
 	DBResult_ptr result;
 	if (task.store) {
@@ -66,20 +200,36 @@ void DatabaseTasks::runTask(const DatabaseTask& task) {
 }
 
 void DatabaseTasks::flush() {
-	std::unique_lock<std::mutex> guard{ taskLock };
-	while (!tasks.empty()) {
-		auto task = std::move(tasks.front());
-		tasks.pop_front();
-		guard.unlock();
-		runTask(task);
-		guard.lock();
-	}
+	// the workers drain the queue, wait until the last task has finished
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	flushSignal.wait(taskLockUnique, [this]() {
+		return tasks.empty() && runningTasks == 0;
+	});
+}
+
+void DatabaseTasks::flush(DatabaseTaskKey key) {
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	flushSignal.wait(taskLockUnique, [this, key]() {
+		if (runningKeys.contains(key)) {
+			return false;
+		}
+		return std::none_of(tasks.begin(), tasks.end(), [key](const DatabaseTask& task) { return task.key == key; });
+	});
 }
 
 void DatabaseTasks::shutdown() {
 	taskLock.lock();
 	setState(THREAD_STATE_TERMINATED);
 	taskLock.unlock();
+	taskSignal.notify_all();
 	flush();
-	taskSignal.notify_one();
+}
+
+void DatabaseTasks::join() {
+	ThreadHolder::join();
+	for (std::thread& worker : workers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
 }
\ No newline at end of file
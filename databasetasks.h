@@ -8,33 +8,77 @@
 
 #include "thread_holder_base.h"
 
+// tasks with the same key run one at a time in the order they were added, different keys run in parallel
+using DatabaseTaskKey = uint64_t;
+
+static constexpr DatabaseTaskKey DATABASE_TASK_DEFAULT = 0;
+static constexpr DatabaseTaskKey DATABASE_TASK_MARKET = 1;
+static constexpr DatabaseTaskKey DATABASE_TASK_SCRIPTS = 2;
+static constexpr DatabaseTaskKey DATABASE_TASK_UNORDERED = std::numeric_limits<DatabaseTaskKey>::max();
+
+constexpr DatabaseTaskKey getPlayerTaskKey(uint32_t guid) {
+	return (DatabaseTaskKey{1} << 32) | guid;
+}
+
 struct DatabaseTask {
-	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
-		query(std::move(query)), callback(std::move(callback)), store(store) {}
+	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store, DatabaseTaskKey key) :
+		query(std::move(query)), callback(std::move(callback)), key(key), store(store) {}
+	DatabaseTask(std::function<void(Database&)>&& job, DatabaseTaskKey key) : job(std::move(job)), key(key) {}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
-	bool store;
+	// runs on a database worker with its connection, must dispatch its own results
+	std::function<void(Database&)> job;
+	DatabaseTaskKey key;
+	int64_t queuedAt = 0;
+	bool store = false;
+	// may be merged with the following inserts of its key, see addBatchedInsert
+	bool batched = false;
+};
+
+struct DatabaseTaskStats {
+	size_t queued = 0;
+	uint64_t executed = 0;
+	uint64_t batched = 0;
+	int64_t totalWait = 0;
+	int64_t totalRun = 0;
+	int64_t maxRun = 0;
 };
 
 class DatabaseTasks : public ThreadHolder<DatabaseTasks> {
 	public:
 		DatabaseTasks() = default;
-		void start();
+		bool start();
 		void flush();
+		// waits only for the tasks of one key, the others keep running
+		void flush(DatabaseTaskKey key);
 		void shutdown();
+		void join();
+
+		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false, DatabaseTaskKey key = DATABASE_TASK_DEFAULT);
+		void addTask(std::function<void(Database&)> job, DatabaseTaskKey key = DATABASE_TASK_DEFAULT);
+		// a plain INSERT nobody waits for, merged with the next inserts of the key into the same columns
+		void addBatchedInsert(std::string query, DatabaseTaskKey key);
 
-		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		DatabaseTaskStats getStats();
 
 		void threadMain();
 	private:
-		void runTask(const DatabaseTask& task);
+		void workerMain(Database& db);
+		std::optional<DatabaseTask> takeTask();
+		void batchInserts(std::list<DatabaseTask>::iterator first, DatabaseTask& task);
+		void runTask(Database& db, const DatabaseTask& task);
 
-		Database db;
-		std::thread thread;
+		// one connection per worker, the first one belongs to the ThreadHolder thread
+		std::vector<std::unique_ptr<Database>> databases;
+		std::vector<std::thread> workers;
 		std::list<DatabaseTask> tasks;
+		std::unordered_set<DatabaseTaskKey> runningKeys;
+		size_t runningTasks = 0;
+		DatabaseTaskStats stats;
 		std::mutex taskLock;
 		std::condition_variable taskSignal;
+		std::condition_variable flushSignal;
 };
 
 extern DatabaseTasks g_databaseTasks;
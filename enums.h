@@ -519,12 +519,6 @@ struct MarketOffer {
 };
 
 struct MarketOfferEx {
-	MarketOfferEx() = default;
-	MarketOfferEx(MarketOfferEx&& other) :
-		id(other.id), playerId(other.playerId), timestamp(other.timestamp), price(other.price),
-		amount(other.amount), counter(other.counter), itemId(other.itemId), type(other.type),
-		playerName(std::move(other.playerName)) {}
-
 	uint32_t id;
 	uint32_t playerId;
 	uint32_t timestamp;
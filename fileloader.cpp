@@ -5,8 +5,6 @@
 
 #include "fileloader.h"
 
-#include <stack>
-
 namespace OTB {
 
 	constexpr Identifier wildcard = {{'\0', '\0', '\0', '\0'}};
@@ -24,51 +22,97 @@ namespace OTB {
 		}
 	}
 
-	using NodeStack = std::stack<Node*, std::vector<Node*>>;
-	static Node& getCurrentNode(const NodeStack& nodeStack) {
-		if (nodeStack.empty()) {
+	Node Loader::getRoot() {
+		cursor = fileContents.begin() + sizeof(Identifier);
+		if (static_cast<uint8_t>(*cursor) != Node::START) {
 			throw InvalidOTBFormat{};
 		}
-		return *nodeStack.top();
+
+		Node root;
+		root.type = *(++cursor);
+		root.depth = depth = 1;
+		propsPending = true;
+		root.propsBegin = ++cursor;
+		return root;
 	}
 
-	const Node& Loader::parseTree() {
-		auto it = fileContents.begin() + sizeof(Identifier);
-		if (static_cast<uint8_t>(*it) != Node::START) {
+	bool Loader::getProps(const Node& node, PropStream& props) {
+		if (!propsPending || node.depth != depth) {
+			return false;
+		}
+		propsPending = false;
+
+		// the properties end at the first unescaped node marker, they are only copied if they contain escapes
+		auto propsBegin = cursor;
+		bool escaped = false;
+		for (; cursor != fileContents.end(); ++cursor) {
+			auto byte = static_cast<uint8_t>(*cursor);
+			if (byte == Node::START || byte == Node::END) {
+				break;
+			} else if (byte == Node::ESCAPE) {
+				escaped = true;
+				if (++cursor == fileContents.end()) {
+					throw InvalidOTBFormat{};
+				}
+			}
+		}
+
+		if (cursor == fileContents.end()) {
 			throw InvalidOTBFormat{};
 		}
-		root.type = *(++it);
-		root.propsBegin = ++it;
-		NodeStack parseStack;
-		parseStack.push(&root);
 
-		for (; it != fileContents.end(); ++it) {
-			switch (static_cast<uint8_t>(*it)) {
+		auto size = std::distance(propsBegin, cursor);
+		if (size == 0) {
+			return false;
+		}
+
+		if (!escaped) {
+			props.init(propsBegin, size);
+			return true;
+		}
+
+		propBuffer.resize(size);
+		bool lastEscaped = false;
+
+		auto escapedPropEnd = std::copy_if(propsBegin, cursor, propBuffer.begin(), [&lastEscaped](const char& byte) {
+			lastEscaped = byte == static_cast<char>(Node::ESCAPE) && !lastEscaped;
+			return !lastEscaped;
+		});
+		props.init(&propBuffer[0], std::distance(propBuffer.begin(), escapedPropEnd));
+		return true;
+	}
+
+	bool Loader::nextChild(const Node& parent, Node& child) {
+		if (depth < parent.depth) {
+			return false;
+		}
+
+		propsPending = false;
+		for (; cursor != fileContents.end(); ++cursor) {
+			switch (static_cast<uint8_t>(*cursor)) {
 				case Node::START: {
-					auto& currentNode = getCurrentNode(parseStack);
-					if (currentNode.children.empty()) {
-						currentNode.propsEnd = it;
-					}
-					currentNode.children.emplace_back();
-					auto& child = currentNode.children.back();
-					if (++it == fileContents.end()) {
+					if (++cursor == fileContents.end()) {
 						throw InvalidOTBFormat{};
 					}
-					child.type = *it;
-					child.propsBegin = it + sizeof(Node::type);
-					parseStack.push(&child);
+
+					if (++depth == parent.depth + 1) {
+						child.type = *cursor;
+						child.depth = depth;
+						propsPending = true;
+						child.propsBegin = ++cursor;
+						return true;
+					}
 					break;
 				}
 				case Node::END: {
-					auto& currentNode = getCurrentNode(parseStack);
-					if (currentNode.children.empty()) {
-						currentNode.propsEnd = it;
+					if (--depth < parent.depth) {
+						++cursor;
+						return false;
 					}
-					parseStack.pop();
 					break;
 				}
 				case Node::ESCAPE: {
-					if (++it == fileContents.end()) {
+					if (++cursor == fileContents.end()) {
 						throw InvalidOTBFormat{};
 					}
 					break;
@@ -78,27 +122,13 @@ namespace OTB {
 				}
 			}
 		}
-		if (!parseStack.empty()) {
-			throw InvalidOTBFormat{};
-		}
-
-		return root;
+		throw InvalidOTBFormat{};
 	}
 
-	bool Loader::getProps(const Node& node, PropStream& props) {
-		auto size = std::distance(node.propsBegin, node.propsEnd);
-		if (size == 0) {
-			return false;
-		}
-		propBuffer.resize(size);
-		bool lastEscaped = false;
-
-		auto escapedPropEnd = std::copy_if(node.propsBegin, node.propsEnd, propBuffer.begin(), [&lastEscaped](const char& byte) {
-			lastEscaped = byte == static_cast<char>(Node::ESCAPE) && !lastEscaped;
-			return !lastEscaped;
-		});
-		props.init(&propBuffer[0], std::distance(propBuffer.begin(), escapedPropEnd));
-		return true;
+	void Loader::rewind(const Node& node) {
+		cursor = node.propsBegin;
+		depth = node.depth;
+		propsPending = true;
 	}
 
 } //namespace OTB
\ No newline at end of file
@@ -14,13 +14,11 @@ namespace OTB {
 
 	using Identifier = std::array<char, 4>;
 
+	// a node of the file being read, its properties and children are read from the loader while it is the current one
 	struct Node {
-		using ChildrenVector = std::vector<Node>;
-
-		ChildrenVector children;
-		ContentIt propsBegin;
-		ContentIt propsEnd;
-		uint8_t type;
+		ContentIt propsBegin = nullptr;
+		uint8_t type = 0;
+		size_t depth = 0;
 		enum NodeChar: uint8_t {
 			ESCAPE = 0xFD,
 			START = 0xFE,
@@ -38,14 +36,26 @@ namespace OTB {
 		}
 	};
 
+	// reads the nodes in file order straight from the mapped file, no tree is built
 	class Loader {
 		MappedFile fileContents;
-		Node root;
+		ContentIt cursor;
+		size_t depth = 0;
+		bool propsPending = false;
 		std::vector<char> propBuffer;
 		public:
 			Loader(const std::string& fileName, const Identifier& acceptedIdentifier);
+			Node getRoot();
+			// the props stay valid until the next node is read
 			bool getProps(const Node& node, PropStream& props);
-			const Node& parseTree();
+			// skips whatever is left of the previous child, returns false once the parent is closed
+			bool nextChild(const Node& parent, Node& child);
+			// goes back to a node passed earlier, e.g. on a copy of the loader used by another thread
+			void rewind(const Node& node);
+
+			std::string_view getContents() const {
+				return {fileContents.data(), fileContents.size()};
+			}
 	};
 
 } //namespace OTB
@@ -61,6 +71,11 @@ class PropStream {
 			return end - p;
 		}
 
+		// what is left to be read
+		std::string_view view() const {
+			return {p, size()};
+		}
+
 		template <typename T>
 		bool read(T& ret) {
 			if (size() < sizeof(T)) {
@@ -134,6 +149,10 @@ class PropWriteStream {
 			std::copy(str.begin(), str.end(), std::back_inserter(buffer));
 		}
 
+		void writeBytes(std::string_view bytes) {
+			buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+		}
+
 	private:
 		std::vector<char> buffer;
 };
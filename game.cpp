@@ -17,6 +17,7 @@
 #include "housetile.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "iomapserialize.h"
 #include "iomarket.h"
 #include "items.h"
 #include "monster.h"
@@ -84,6 +85,15 @@ void Game::start(ServiceManager* manager) {
 		checkDecay();
 	}));
 
+	g_scheduler.addEvent(createSchedulerTask(EVENT_PLAYER_SAVE_INTERVAL, [this]() {
+		checkPlayerSaves();
+	}));
+
+	if (map.getPager()) {
+		g_scheduler.addEvent(createSchedulerTask(EVENT_MAP_REGIONS_INTERVAL, [this]() {
+			checkMapRegions();
+		}));
+	}
 }
 
 GameState_t Game::getGameState() const {
@@ -176,26 +186,388 @@ void Game::saveGameState() {
 
 	std::cout << "Saving server..." << std::endl;
 
-	if (!saveAccountStorageValues()) {
-		std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
+	// shutdown and close saves stay synchronous
+	if (getBoolean(ConfigManager::ASYNC_SERVER_SAVE) && gameState == GAME_STATE_MAINTAIN) {
+		saveGameStateAsync();
+	} else {
+		// an asynchronous server save still in flight must not overwrite the newer state written here
+		if (pendingServerSaves != 0) {
+			g_databaseTasks.flush();
+		}
+
+		if (!saveAccountStorageValues()) {
+			std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
+		}
+
+		for (const auto& it : players) {
+			it.second->loginPosition = it.second->getPosition();
+			IOLoginData::savePlayer(it.second);
+		}
+
+		Map::save();
+
+		g_databaseTasks.flush();
+	}
+
+	if (gameState == GAME_STATE_MAINTAIN) {
+		setGameState(GAME_STATE_NORMAL);
+	}
+}
+
+bool Game::canReleaseTile(const Tile* tile) const {
+	if (browseFields.contains(const_cast<Tile*>(tile))) {
+		return false;
+	}
+
+	if (const TileCreatureVector* creatures = tile->getCreatures(); creatures && !creatures->empty()) {
+		return false;
+	}
+
+	// decaying items and unique ids are pointed to by the game, items not from the map file would be lost
+	auto isReferenced = [](const Item* item) {
+		return item->getDecaying() != DECAYING_FALSE || item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+	};
+
+	auto isInUse = [&isReferenced](const Item* item) {
+		if (!item->isLoadedFromMap() || isReferenced(item)) {
+			return true;
+		}
+
+		if (const Container* container = item->getContainer()) {
+			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+				if (isReferenced(*it)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	if (const Item* ground = tile->getGround(); ground && isInUse(ground)) {
+		return false;
+	}
+
+	if (const TileItemVector* items = tile->getItemList()) {
+		for (const Item* item : *items) {
+			if (isInUse(item)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+std::unordered_set<const Tile*> Game::getTilesInUse() const {
+	std::unordered_set<const Tile*> tiles;
+	for (const auto& it : players) {
+		for (const auto& openContainer : it.second->openContainers) {
+			if (const Tile* tile = openContainer.second.container->getTile()) {
+				tiles.insert(tile);
+			}
+		}
+	}
+
+	for (const auto& it : tradeItems) {
+		if (const Tile* tile = it.first->getTile()) {
+			tiles.insert(tile);
+		}
+	}
+	return tiles;
+}
+
+void Game::releaseTile(Tile* tile) {
+	removeTileToClean(tile);
+}
+
+bool Game::startMapClean(std::function<void(uint32_t, size_t)> callback) {
+	if (mapClean) {
+		return false;
+	}
+
+	mapClean = std::make_unique<MapClean>();
+	mapClean->callback = std::move(callback);
+	// tiles that become dirty during the clean may be picked up, but never more than were queued at the start
+	mapClean->remainingTiles = tilesToClean.size();
+	mapClean->start = OTSYS_TIME();
+	cleanMapSlice();
+	return true;
+}
+
+void Game::cleanMapSlice() {
+	const int64_t sliceStart = OTSYS_TIME();
+	const bool skipVisibleTiles = getBoolean(ConfigManager::CLEAN_SKIP_VISIBLE_TILES);
+
+	std::vector<Item*> toRemove;
+	for (int64_t budget = std::max<int64_t>(1, getNumber(ConfigManager::CLEAN_TILES_PER_SLICE)); budget > 0 && mapClean->remainingTiles > 0 && !tilesToClean.empty(); --budget) {
+		--mapClean->remainingTiles;
+
+		auto it = tilesToClean.begin();
+		Tile* tile = *it;
+		tilesToClean.erase(it);
+
+		if (skipVisibleTiles) {
+			SpectatorVec spectators;
+			map.getSpectators(spectators, tile->getPosition(), true, true);
+			if (!spectators.empty()) {
+				mapClean->skippedTiles.insert(tile);
+				continue;
+			}
+		}
+
+		auto items = tile->getItemList();
+		if (!items) {
+			continue;
+		}
+
+		++mapClean->tiles;
+		for (auto item : *items) {
+			if (item->isCleanable()) {
+				toRemove.push_back(item);
+			}
+		}
+
+		for (auto item : toRemove) {
+			internalRemoveItem(item, -1);
+		}
+
+		mapClean->items += toRemove.size();
+		toRemove.clear();
+	}
+
+	mapClean->longestSlice = std::max<int64_t>(mapClean->longestSlice, OTSYS_TIME() - sliceStart);
+	if (mapClean->remainingTiles > 0 && !tilesToClean.empty()) {
+		g_scheduler.addEvent(createSchedulerTask(EVENT_MAPCLEAN_INTERVAL, [this]() {
+			cleanMapSlice();
+		}));
+		return;
+	}
+
+	// tiles in view of a player wait for the next clean
+	tilesToClean.insert(mapClean->skippedTiles.begin(), mapClean->skippedTiles.end());
+
+	// the callback may start the next clean
+	std::unique_ptr<MapClean> clean = std::move(mapClean);
+
+	std::cout << "> CLEAN: Removed " << clean->items << " item" << (clean->items != 1 ? "s" : "")
+		<< " from " << clean->tiles << " tile" << (clean->tiles != 1 ? "s" : "") << " in "
+		<< (OTSYS_TIME() - clean->start) / (1000.) << " seconds, longest pause " << clean->longestSlice << " ms." << std::endl;
+
+	if (clean->callback) {
+		clean->callback(clean->items, clean->tiles);
+	}
+}
+
+void Game::saveGameStateAsync() {
+	// the dispatcher only serializes, the statements are written on the database thread
+	int64_t start = OTSYS_TIME();
+
+	// a partial set of statements would delete the rows it misses, so it is not written at all
+	std::vector<std::string> accountStorage;
+	if (!serializeAccountStorageValues(accountStorage)) {
+		accountStorage.clear();
 	}
 
 	for (const auto& it : players) {
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		IOLoginData::savePlayerAsync(it.second);
 	}
 
-	Map::save();
+	std::vector<std::string> houseInfo, houseItems;
+	HouseItemRevisions houseRevisions;
+	IOMapSerialize::serializeHouseInfo(houseInfo);
+	IOMapSerialize::serializeHouseItems(houseItems, houseRevisions);
 
-	g_databaseTasks.flush();
+	std::cout << "> Serialized server in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
 
-	if (gameState == GAME_STATE_MAINTAIN) {
-		setGameState(GAME_STATE_NORMAL);
+	++pendingServerSaves;
+	g_databaseTasks.addTask([start, accountStorage = std::move(accountStorage), houseInfo = std::move(houseInfo), houseItems = std::move(houseItems), houseRevisions = std::move(houseRevisions)](Database& db) {
+		auto write = [&db](const std::vector<std::string>& statements) {
+			for (uint32_t tries = 0; tries < 3; tries++) {
+				if (db.executeTransaction(statements)) {
+					return true;
+				}
+			}
+			return false;
+		};
+
+		bool accountStorageSaved = !accountStorage.empty() && write(accountStorage);
+		bool mapSaved = write(houseInfo) && (houseItems.empty() || write(houseItems));
+
+		// the player saves of this server save are written in parallel on their own keys
+		g_dispatcher.addTask([=]() {
+			--g_game.pendingServerSaves;
+			if (!accountStorageSaved) {
+				std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
+			}
+			if (!mapSaved) {
+				std::cout << "[Error - Game::saveGameState] Failed to save houses." << std::endl;
+			} else {
+				IOMapSerialize::setHouseItemsSaved(houseRevisions);
+			}
+			std::cout << "> Saved server in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+		});
+	});
+}
+
+void Game::removePendingPlayerSave(uint32_t guid, bool offline) {
+	auto it = pendingPlayerSaves.find(guid);
+	if (it != pendingPlayerSaves.end() && --it->second == 0) {
+		pendingPlayerSaves.erase(it);
+	}
+
+	// a login fetch queued ahead of the save on the character's key read the rows it replaced
+	if (offline) {
+		addOfflinePlayerSave(guid);
+	}
+}
+
+void Game::requestPlayerSave(const Player* player) {
+	if (getNumber(ConfigManager::PLAYER_SAVE_INTERVAL) <= 0) {
+		return;
+	}
+
+	if (prioritySaves.insert(player->getID()).second) {
+		prioritySaveQueue.emplace_back(player->getID(), OTSYS_TIME());
+	}
+}
+
+size_t Game::getPlayerSaveBacklog() const {
+	// the rotation is ordered by due time, so the overdue saves are at the front
+	const int64_t now = OTSYS_TIME();
+	size_t backlog = prioritySaves.size();
+	for (const auto& it : playerSaveQueue) {
+		if (it.first > now) {
+			break;
+		}
+		++backlog;
+	}
+	return backlog;
+}
+
+void Game::schedulePlayerSave(uint32_t playerId, int64_t due) {
+	auto [it, inserted] = playerSaveDue.try_emplace(playerId, due);
+	if (!inserted) {
+		playerSaveQueue.erase({it->second, playerId});
+		it->second = due;
 	}
+	playerSaveQueue.emplace(due, playerId);
 }
 
-bool Game::loadMainMap(const std::string& filename) {
-	return map.loadMap("data/world/" + filename + ".otbm", true, false);
+void Game::savePlayerRolling(Player* player) {
+	player->loginPosition = player->getPosition();
+	if (getBoolean(ConfigManager::ASYNC_SERVER_SAVE)) {
+		IOLoginData::savePlayerAsync(player);
+	} else if (!IOLoginData::savePlayer(player)) {
+		std::cout << "[Error - Game::savePlayerRolling] Failed to save player: " << player->getName() << std::endl;
+	}
+	++playerSavesSinceReport;
+}
+
+void Game::checkMapRegions() {
+	g_scheduler.addEvent(createSchedulerTask(EVENT_MAP_REGIONS_INTERVAL, [this]() {
+		checkMapRegions();
+	}));
+
+	map.unloadIdleRegions(static_cast<int64_t>(getNumber(ConfigManager::MAP_REGION_IDLE_TIME)) * 1000);
+}
+
+void Game::checkPlayerSaves() {
+	g_scheduler.addEvent(createSchedulerTask(EVENT_PLAYER_SAVE_INTERVAL, [this]() {
+		checkPlayerSaves();
+	}));
+
+	const int64_t interval = static_cast<int64_t>(getNumber(ConfigManager::PLAYER_SAVE_INTERVAL)) * 1000;
+	if (interval <= 0 || gameState != GAME_STATE_NORMAL) {
+		return;
+	}
+
+	const int64_t now = OTSYS_TIME();
+	if (lastPlayerSaveReport == 0) {
+		lastPlayerSaveReport = now;
+	}
+
+	// spread the rotation so every player is saved once per interval
+	size_t budget = std::max<size_t>(1, (players.size() * EVENT_PLAYER_SAVE_INTERVAL + interval - 1) / interval);
+	playerSaveDelay = 0;
+
+	// priority saves come out of the same budget and push the player back in the rotation
+	while (budget > 0 && !prioritySaveQueue.empty()) {
+		auto [playerId, requestedAt] = prioritySaveQueue.front();
+		prioritySaveQueue.pop_front();
+
+		// players that logged out were taken out of prioritySaves already
+		if (prioritySaves.erase(playerId) == 0) {
+			continue;
+		}
+
+		if (Player* player = getPlayerByID(playerId)) {
+			playerSaveDelay = std::max<int64_t>(playerSaveDelay, now - requestedAt);
+			savePlayerRolling(player);
+			schedulePlayerSave(playerId, now + interval);
+			--budget;
+		}
+	}
+
+	while (budget > 0 && !playerSaveQueue.empty() && playerSaveQueue.begin()->first <= now) {
+		auto [due, playerId] = *playerSaveQueue.begin();
+		Player* player = getPlayerByID(playerId);
+		if (!player) {
+			playerSaveQueue.erase(playerSaveQueue.begin());
+			playerSaveDue.erase(playerId);
+			continue;
+		}
+
+		playerSaveDelay = std::max<int64_t>(playerSaveDelay, now - due);
+		savePlayerRolling(player);
+		schedulePlayerSave(playerId, now + interval);
+		--budget;
+	}
+
+	if (now - lastPlayerSaveReport >= interval) {
+		std::cout << "> Rolling save: " << playerSavesSinceReport << " players saved, backlog " << getPlayerSaveBacklog() << ", delay " << playerSaveDelay / 1000. << " s" << std::endl;
+		lastPlayerSaveReport = now;
+		playerSavesSinceReport = 0;
+	}
+}
+
+void Game::addOfflinePlayerSave(uint32_t guid) {
+	++playerSaveSequence;
+	if (!playerLoads.empty()) {
+		lastOfflinePlayerSaves[guid] = playerSaveSequence;
+	}
+}
+
+uint32_t Game::startPlayerLoad() {
+	playerLoads.insert(playerSaveSequence);
+	return playerSaveSequence;
+}
+
+void Game::finishPlayerLoad(uint32_t playerSaveSequence) {
+	auto it = playerLoads.find(playerSaveSequence);
+	if (it != playerLoads.end()) {
+		playerLoads.erase(it);
+	}
+
+	if (playerLoads.empty()) {
+		lastOfflinePlayerSaves.clear();
+		return;
+	}
+
+	// saves the oldest fetch in flight already read are of no interest to any of them
+	const uint32_t oldestLoad = *playerLoads.begin();
+	std::erase_if(lastOfflinePlayerSaves, [oldestLoad](const auto& it) { return it.second <= oldestLoad; });
+}
+
+uint32_t Game::getLastOfflinePlayerSave(uint32_t guid) const {
+	auto it = lastOfflinePlayerSaves.find(guid);
+	if (it == lastOfflinePlayerSaves.end()) {
+		return 0;
+	}
+	return it->second;
+}
+
+bool Game::loadMainMap(IOMap& loader) {
+	return map.loadMap(loader, true, false);
 }
 
 void Game::loadMap(const std::string& path, bool isCalledByLua) {
@@ -744,7 +1116,7 @@ void Game::playerMoveCreature(Player* player, Creature* movingCreature, const Po
 			player->sendCancelMessage(RETURNVALUE_NOTPOSSIBLE);
 			return;
 		} else {
-			if (CreatureVector* tileCreatures = toTile->getCreatures()) {
+			if (TileCreatureVector* tileCreatures = toTile->getCreatures()) {
 				for (Creature* tileCreature : *tileCreatures) {
 					if (!tileCreature->isInGhostMode()) {
 						player->sendCancelMessage(RETURNVALUE_NOTENOUGHROOM);
@@ -1430,6 +1802,14 @@ Item* Game::findItemOfType(Cylinder* cylinder, uint16_t itemId,
 		return nullptr;
 	}
 
+	// the inventory of a player is indexed by item type, so misses are cheap
+	const Creature* creature = cylinder->getCreature();
+	if (const Player* player = creature ? creature->getPlayer() : nullptr) {
+		if (player->getItemTypeCount(itemId) == 0) {
+			return nullptr;
+		}
+	}
+
 	std::vector<Container*> containers;
 	for (size_t i = cylinder->getFirstIndex(), j = cylinder->getLastIndex(); i < j; ++i) {
 		Thing* thing = cylinder->getThing(i);
@@ -1480,6 +1860,13 @@ bool Game::removeMoney(Cylinder* cylinder, uint64_t money, uint32_t flags /*= 0*
 		return true;
 	}
 
+	const Creature* creature = cylinder->getCreature();
+	if (const Player* player = creature ? creature->getPlayer() : nullptr) {
+		if (player->getMoney() < money) {
+			return false;
+		}
+	}
+
 	std::vector<Container*> containers;
 
 	std::multimap<uint32_t, Item*> moneyMap;
@@ -2416,6 +2803,7 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, std::string
 		writeItem->resetWriter();
 		writeItem->resetDate();
 	}
+	writeItem->notifyHouseChange();
 
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
@@ -2808,6 +3196,11 @@ void Game::playerAcceptTrade(uint32_t playerId) {
 
 		events::player::onTradeCompleted(player, tradePartner, playerTradeItem, partnerTradeItem, isSuccess);
 
+		if (isSuccess) {
+			requestPlayerSave(player);
+			requestPlayerSave(tradePartner);
+		}
+
 		player->setTradeState(TRADE_NONE);
 		player->tradeItem = nullptr;
 		player->tradePartner = nullptr;
@@ -3765,7 +4158,7 @@ void Game::changeLight(const Creature* creature) {
 	}
 }
 
-bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor, bool field, bool ignoreResistances /*= false */) {
+bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor, bool field, bool ignoreResistances /*= false */, CombatBatch* batch /*= nullptr*/) {
 	if (damage.primary.type == COMBAT_NONE && damage.secondary.type == COMBAT_NONE) {
 		return true;
 	}
@@ -3774,13 +4167,13 @@ bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* ta
 		return true;
 	}
 
-	static const auto sendBlockEffect = [this](BlockType_t blockType, CombatType_t combatType, const Position& targetPos) {
+	static const auto sendBlockEffect = [this](BlockType_t blockType, CombatType_t combatType, const Position& targetPos, CombatBatch* batch) {
+		uint8_t hitEffect = 0;
 		if (blockType == BLOCK_DEFENSE) {
-			addMagicEffect(targetPos, CONST_ME_POFF);
+			hitEffect = CONST_ME_POFF;
 		} else if (blockType == BLOCK_ARMOR) {
-			addMagicEffect(targetPos, CONST_ME_BLOCKHIT);
+			hitEffect = CONST_ME_BLOCKHIT;
 		} else if (blockType == BLOCK_IMMUNITY) {
-			uint8_t hitEffect = 0;
 			switch (combatType) {
 				case COMBAT_UNDEFINEDDAMAGE: {
 					return;
@@ -3806,8 +4199,11 @@ bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* ta
 					break;
 				}
 			}
-			addMagicEffect(targetPos, hitEffect);
+		} else {
+			return;
 		}
+
+		addCombatMagicEffect(targetPos, hitEffect, batch);
 	};
 
 	BlockType_t primaryBlockType, secondaryBlockType;
@@ -3818,7 +4214,7 @@ bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* ta
 		if (damage.primary.type != COMBAT_HEALING) {
 			damage.primary.value = -damage.primary.value;
 		}
-		sendBlockEffect(primaryBlockType, damage.primary.type, target->getPosition());
+		sendBlockEffect(primaryBlockType, damage.primary.type, target->getPosition(), batch);
 	} else {
 		primaryBlockType = BLOCK_NONE;
 	}
@@ -3829,7 +4225,7 @@ bool Game::combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* ta
 		if (damage.secondary.type != COMBAT_HEALING) {
 			damage.secondary.value = -damage.secondary.value;
 		}
-		sendBlockEffect(secondaryBlockType, damage.secondary.type, target->getPosition());
+		sendBlockEffect(secondaryBlockType, damage.secondary.type, target->getPosition(), batch);
 	} else {
 		secondaryBlockType = BLOCK_NONE;
 	}
@@ -3934,7 +4330,7 @@ void Game::combatGetTypeInfo(CombatType_t combatType, Creature* target, TextColo
 	}
 }
 
-bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage) {
+bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage, CombatBatch* batch /*= nullptr*/) {
 	const Position& targetPos = target->getPosition();
 	if (damage.primary.value > 0) {
 		if (target->isDead()) {
@@ -3960,7 +4356,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					creatureEvent->executeHealthChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
-				return combatChangeHealth(attacker, target, damage);
+				return combatChangeHealth(attacker, target, damage, batch);
 			}
 		}
 
@@ -3979,7 +4375,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			message.primary.color = TEXTCOLOR_PASTELRED;
 
 			SpectatorVec spectators;
-			map.getSpectators(spectators, targetPos, false, true);
+			getCombatSpectators(spectators, targetPos, false, batch);
 			for (Creature* spectator : spectators) {
 				assert(dynamic_cast<Player*>(spectator) != nullptr);
 				Player* spectatorPlayer = static_cast<Player*>(spectator);
@@ -4009,13 +4405,13 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					}
 					message.text = spectatorMessage;
 				}
-				spectatorPlayer->sendTextMessage(message);
+				sendCombatTextMessage(spectatorPlayer, message, batch);
 			}
 		}
 	} else {
 		if (!target->isAttackable()) {
 			if (!target->isInGhostMode()) {
-				addMagicEffect(targetPos, CONST_ME_POFF);
+				addCombatMagicEffect(targetPos, CONST_ME_POFF, batch);
 			}
 			return true;
 		}
@@ -4062,8 +4458,8 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 				}
 
 				targetPlayer->drainMana(attacker, manaDamage);
-				map.getSpectators(spectators, targetPos, true, true);
-				addMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
+				getCombatSpectators(spectators, targetPos, true, batch);
+				addCombatMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY, batch);
 
 				std::string spectatorMessage;
 
@@ -4104,7 +4500,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 						}
 						message.text = spectatorMessage;
 					}
-					spectatorPlayer->sendTextMessage(message);
+					sendCombatTextMessage(spectatorPlayer, message, batch);
 				}
 
 				damage.primary.value -= manaDamage;
@@ -4127,7 +4523,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					creatureEvent->executeHealthChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
-				return combatChangeHealth(attacker, target, damage);
+				return combatChangeHealth(attacker, target, damage, batch);
 			}
 		}
 
@@ -4145,7 +4541,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		if (spectators.empty()) {
-			map.getSpectators(spectators, targetPos, true, true);
+			getCombatSpectators(spectators, targetPos, true, batch);
 		}
 
 		message.primary.value = damage.primary.value;
@@ -4155,14 +4551,14 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		if (message.primary.value) {
 			combatGetTypeInfo(damage.primary.type, target, message.primary.color, hitEffect);
 			if (hitEffect != CONST_ME_NONE) {
-				addMagicEffect(spectators, targetPos, hitEffect);
+				addCombatMagicEffect(spectators, targetPos, hitEffect, batch);
 			}
 		}
 
 		if (message.secondary.value) {
 			combatGetTypeInfo(damage.secondary.type, target, message.secondary.color, hitEffect);
 			if (hitEffect != CONST_ME_NONE) {
-				addMagicEffect(spectators, targetPos, hitEffect);
+				addCombatMagicEffect(spectators, targetPos, hitEffect, batch);
 			}
 		}
 
@@ -4205,7 +4601,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					}
 					message.text = spectatorMessage;
 				}
-				spectatorPlayer->sendTextMessage(message);
+				sendCombatTextMessage(spectatorPlayer, message, batch);
 			}
 		}
 
@@ -4218,13 +4614,17 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		target->drainHealth(attacker, realDamage);
-		addCreatureHealth(spectators, target);
+		if (batch) {
+			batch->addCreatureHealth(target);
+		} else {
+			addCreatureHealth(spectators, target);
+		}
 	}
 
 	return true;
 }
 
-bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage) {
+bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage, CombatBatch* batch /*= nullptr*/) {
 	Player* targetPlayer = target->getPlayer();
 	if (!targetPlayer) {
 		return true;
@@ -4246,7 +4646,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 					creatureEvent->executeManaChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
-				return combatChangeMana(attacker, target, damage);
+				return combatChangeMana(attacker, target, damage, batch);
 			}
 		}
 
@@ -4259,13 +4659,13 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 			message.position = target->getPosition();
 			message.primary.value = realManaChange;
 			message.primary.color = TEXTCOLOR_MAYABLUE;
-			targetPlayer->sendTextMessage(message);
+			sendCombatTextMessage(targetPlayer, message, batch);
 		}
 	} else {
 		const Position& targetPos = target->getPosition();
 		if (!target->isAttackable()) {
 			if (!target->isInGhostMode()) {
-				addMagicEffect(targetPos, CONST_ME_POFF);
+				addCombatMagicEffect(targetPos, CONST_ME_POFF, batch);
 			}
 			return false;
 		}
@@ -4284,7 +4684,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 		int32_t manaLoss = std::min<int32_t>(targetPlayer->getMana(), -manaChange);
 		BlockType_t blockType = target->blockHit(attacker, COMBAT_MANADRAIN, manaLoss);
 		if (blockType != BLOCK_NONE) {
-			addMagicEffect(targetPos, CONST_ME_POFF);
+			addCombatMagicEffect(targetPos, CONST_ME_POFF, batch);
 			return false;
 		}
 
@@ -4299,7 +4699,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 					creatureEvent->executeManaChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
-				return combatChangeMana(attacker, target, damage);
+				return combatChangeMana(attacker, target, damage, batch);
 			}
 		}
 
@@ -4313,7 +4713,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 		message.primary.color = TEXTCOLOR_BLUE;
 
 		SpectatorVec spectators;
-		map.getSpectators(spectators, targetPos, false, true);
+		getCombatSpectators(spectators, targetPos, false, batch);
 		for (Creature* spectator : spectators) {
 			assert(dynamic_cast<Player*>(spectator) != nullptr);
 			Player* spectatorPlayer = static_cast<Player*>(spectator);
@@ -4344,13 +4744,45 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 				}
 				message.text = spectatorMessage;
 			}
-			spectatorPlayer->sendTextMessage(message);
+			sendCombatTextMessage(spectatorPlayer, message, batch);
 		}
 	}
 
 	return true;
 }
 
+void Game::getCombatSpectators(SpectatorVec& spectators, const Position& pos, bool multifloor, const CombatBatch* batch) {
+	if (batch) {
+		batch->getSpectators(spectators, pos, multifloor);
+	} else {
+		map.getSpectators(spectators, pos, multifloor, true);
+	}
+}
+
+void Game::addCombatMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect, CombatBatch* batch) {
+	if (batch) {
+		batch->addMagicEffect(pos, effect);
+	} else {
+		addMagicEffect(spectators, pos, effect);
+	}
+}
+
+void Game::addCombatMagicEffect(const Position& pos, uint8_t effect, CombatBatch* batch) {
+	if (batch) {
+		batch->addMagicEffect(pos, effect);
+	} else {
+		addMagicEffect(pos, effect);
+	}
+}
+
+void Game::sendCombatTextMessage(Player* player, const TextMessage& message, CombatBatch* batch) {
+	if (batch) {
+		batch->addTextMessage(player, message);
+	} else {
+		player->sendTextMessage(message);
+	}
+}
+
 void Game::addCreatureHealth(const Creature* target) {
 	SpectatorVec spectators;
 	map.getSpectators(spectators, target->getPosition(), true, true);
@@ -4428,23 +4860,19 @@ void Game::loadAccountStorageValues() {
 }
 
 bool Game::saveAccountStorageValues() const {
-	DBTransaction transaction;
-	Database& db = Database::getInstance();
-
-	if (!transaction.begin()) {
-		return false;
-	}
+	std::vector<std::string> statements;
+	return serializeAccountStorageValues(statements) && Database::getInstance().executeTransaction(statements);
+}
 
-	if (!db.executeQuery("DELETE FROM `account_storage`")) {
-		return false;
-	}
+bool Game::serializeAccountStorageValues(std::vector<std::string>& statements) const {
+	statements.emplace_back("DELETE FROM `account_storage`");
 
 	for (const auto& accountIt : g_game.accountStorageMap) {
 		if (accountIt.second.empty()) {
 			continue;
 		}
 
-		DBInsert accountStorageQuery("INSERT INTO `account_storage` (`account_id`, `key`, `value`) VALUES");
+		DBInsert accountStorageQuery("INSERT INTO `account_storage` (`account_id`, `key`, `value`) VALUES", statements);
 		for (const auto& storageIt : accountIt.second) {
 			if (!accountStorageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", accountIt.first, storageIt.first, storageIt.second))) {
 				return false;
@@ -4455,8 +4883,7 @@ bool Game::saveAccountStorageValues() const {
 			return false;
 		}
 	}
-
-	return transaction.commit();
+	return true;
 }
 
 void Game::startDecay(Item* item) {
@@ -4473,6 +4900,11 @@ void Game::startDecay(Item* item) {
 		item->incrementReferenceCounter();
 		item->setDecaying(DECAYING_TRUE);
 		toDecayItems.push_front(item);
+
+		// the decay state is saved with the item, a pending decay was already saved as decaying
+		if (decayState == DECAYING_FALSE) {
+			item->notifyHouseChange();
+		}
 	} else {
 		internalDecayItem(item);
 	}
@@ -4502,6 +4934,7 @@ void Game::checkDecay() {
 		Item* item = *it;
 		if (!item->canDecay()) {
 			item->setDecaying(DECAYING_FALSE);
+			item->notifyHouseChange();
 			ReleaseItem(item);
 			it = decayItems[bucket].erase(it);
 			continue;
@@ -4535,6 +4968,33 @@ void Game::checkDecay() {
 	cleanup();
 }
 
+void Game::countDecayingHouseItems() {
+	for (const auto& it : map.houses.getHouses()) {
+		it.second->resetDecayingItems();
+	}
+
+	// counted where the items lie right now, a decaying item may have been moved since it started
+	auto countItem = [](const Item* item) {
+		if (item->getDecaying() != DECAYING_TRUE) {
+			return;
+		}
+
+		if (House* house = item->getMapHouse()) {
+			house->addDecayingItem();
+		}
+	};
+
+	for (const Item* item : toDecayItems) {
+		countItem(item);
+	}
+
+	for (const auto& bucket : decayItems) {
+		for (const Item* item : bucket) {
+			countItem(item);
+		}
+	}
+}
+
 void Game::checkLight() {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_LIGHTINTERVAL, [this]() {
 		checkLight();
@@ -5016,6 +5476,11 @@ void Game::playerBrowseMarketOwnHistory(uint32_t playerId) {
 		return;
 	}
 
+	// sent once the history of the player arrived
+	if (!IOMarket::loadHistory(player->getGUID(), [playerId]() { g_game.playerBrowseMarketOwnHistory(playerId); })) {
+		return;
+	}
+
 	const HistoryMarketOfferList& buyOffers = IOMarket::getOwnHistory(MARKETACTION_BUY, player->getGUID());
 	const HistoryMarketOfferList& sellOffers = IOMarket::getOwnHistory(MARKETACTION_SELL, player->getGUID());
 	player->sendMarketBrowseOwnHistory(buyOffers, sellOffers);
@@ -5127,7 +5592,8 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		player->bankBalance -= debitBank;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
+	IOMarket::createOffer(player->getGUID(), player->getName(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
+	requestPlayerSave(player);
 
 	player->sendMarketEnter(player->getLastDepotId());
 	const MarketOfferList& buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.id);
@@ -5194,6 +5660,7 @@ void Game::playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 	offer.timestamp += getNumber(ConfigManager::MARKET_OFFER_DURATION);
 	player->sendMarketCancelOffer(offer);
 	player->sendMarketEnter(player->getLastDepotId());
+	requestPlayerSave(player);
 }
 
 void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16_t counter, uint16_t amount) {
@@ -5306,6 +5773,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			delete buyerPlayer;
 		} else {
 			buyerPlayer->onReceiveMail();
+			requestPlayerSave(buyerPlayer);
 		}
 	} else {
 		uint64_t playerMoney = player->getMoney();
@@ -5350,6 +5818,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		Player* sellerPlayer = getPlayerByGUID(offer.playerId);
 		if (sellerPlayer) {
 			sellerPlayer->bankBalance += totalPrice;
+			requestPlayerSave(sellerPlayer);
 		} else {
 			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
 		}
@@ -5374,6 +5843,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 	player->sendMarketEnter(player->getLastDepotId());
 	offer.timestamp += marketOfferDuration;
 	player->sendMarketAcceptOffer(offer);
+	requestPlayerSave(player);
 }
 
 void Game::parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, const std::string& buffer) {
@@ -5505,6 +5975,11 @@ void Game::addPlayer(Player* player) {
 	mappedPlayerGuids[player->getGUID()] = player;
 	wildcardTree.insert(lowercase_name);
 	players[player->getID()] = player;
+
+	int64_t interval = static_cast<int64_t>(getNumber(ConfigManager::PLAYER_SAVE_INTERVAL)) * 1000;
+	if (interval > 0) {
+		schedulePlayerSave(player->getID(), OTSYS_TIME() + interval);
+	}
 }
 
 void Game::removePlayer(Player* player) {
@@ -5513,6 +5988,16 @@ void Game::removePlayer(Player* player) {
 	mappedPlayerGuids.erase(player->getGUID());
 	wildcardTree.remove(lowercase_name);
 	players.erase(player->getID());
+
+	// the logout saves the player, the rolling save forgets it
+	auto it = playerSaveDue.find(player->getID());
+	if (it != playerSaveDue.end()) {
+		playerSaveQueue.erase({it->second, it->first});
+		playerSaveDue.erase(it);
+	}
+	prioritySaves.erase(player->getID());
+
+	IOMarket::unloadHistory(player->getGUID());
 }
 
 void Game::addNpc(Npc* npc) {
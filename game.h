@@ -12,6 +12,7 @@
 #include "quests.h"
 #include "wildcardtree.h"
 
+class CombatBatch;
 class Monster;
 class Npc;
 class ServiceManager;
@@ -46,6 +47,9 @@ static constexpr int32_t EVENT_LIGHTINTERVAL = 10000;
 static constexpr int32_t EVENT_WORLDTIMEINTERVAL = 2500;
 static constexpr int32_t EVENT_DECAYINTERVAL = 250;
 static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
+static constexpr int32_t EVENT_PLAYER_SAVE_INTERVAL = 1000;
+static constexpr int32_t EVENT_MAPCLEAN_INTERVAL = 50;
+static constexpr int32_t EVENT_MAP_REGIONS_INTERVAL = 10000;
 
 static constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 
@@ -81,7 +85,7 @@ class Game {
 		void forceAddCondition(uint32_t creatureId, Condition* condition);
 		void forceRemoveCondition(uint32_t creatureId, ConditionType_t type);
 
-		bool loadMainMap(const std::string& filename);
+		bool loadMainMap(IOMap& loader);
 		void loadMap(const std::string& path, bool isCalledByLua = false);
 
 		/**
@@ -430,6 +434,32 @@ class Game {
 		void setGameState(GameState_t newState);
 		void saveGameState();
 
+		// player and server saves queued on the database thread, later writes of the same data queue behind them
+		bool hasPendingPlayerSave(uint32_t guid) const {
+			return pendingPlayerSaves.contains(guid);
+		}
+		void addPendingPlayerSave(uint32_t guid) {
+			++pendingPlayerSaves[guid];
+		}
+		void removePendingPlayerSave(uint32_t guid, bool offline);
+		// saves of an offline character, the ones written on the dispatcher are not ordered with its database tasks
+		void addOfflinePlayerSave(uint32_t guid);
+		uint32_t getLastOfflinePlayerSave(uint32_t guid) const;
+		// login fetches in flight, a save is only remembered until every fetch that started before it has finished
+		uint32_t startPlayerLoad();
+		void finishPlayerLoad(uint32_t playerSaveSequence);
+		bool hasPendingServerSave() const {
+			return pendingServerSaves != 0;
+		}
+
+		// rolling autosave, players with valuable changes are saved ahead of the rotation
+		void requestPlayerSave(const Player* player);
+		size_t getPlayerSaveBacklog() const;
+		// how late the saves of the last check started, behind the time they were due or requested
+		int64_t getPlayerSaveDelay() const {
+			return playerSaveDelay;
+		}
+
 		//Events
 		void checkCreatureWalk(uint32_t creatureId);
 		void updateCreatureWalk(uint32_t creatureId);
@@ -437,13 +467,15 @@ class Game {
 		void checkCreatures(size_t index);
 		void updateCreaturesPath(size_t index);
 		void checkLight();
+		void checkPlayerSaves();
+		void checkMapRegions();
 
-		bool combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor, bool field, bool ignoreResistances = false);
+		bool combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor, bool field, bool ignoreResistances = false, CombatBatch* batch = nullptr);
 
 		void combatGetTypeInfo(CombatType_t combatType, Creature* target, TextColor_t& color, uint8_t& effect);
 
-		bool combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage);
-		bool combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage);
+		bool combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage, CombatBatch* batch = nullptr);
+		bool combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage, CombatBatch* batch = nullptr);
 
 		//animation help functions
 		void addCreatureHealth(const Creature* target);
@@ -457,8 +489,11 @@ class Game {
 		int32_t getAccountStorageValue(const uint32_t accountId, const uint32_t key) const;
 		void loadAccountStorageValues();
 		bool saveAccountStorageValues() const;
+		bool serializeAccountStorageValues(std::vector<std::string>& statements) const;
 
 		void startDecay(Item* item);
+		// counts the decaying items of every house, a house with any is saved
+		void countDecayingHouseItems();
 
 		int16_t getWorldTime() { return worldTime; }
 		void updateWorldTime();
@@ -511,7 +546,7 @@ class Game {
 		std::forward_list<Item*> toDecayItems;
 
 		bool isTileInCleanList(Tile* tile) { return tilesToClean.find(tile) != tilesToClean.end(); }
-		std::unordered_set<Tile*> getTilesToClean() const {
+		const std::unordered_set<Tile*>& getTilesToClean() const {
 			return tilesToClean;
 		}
 		void addTileToClean(Tile* tile) {
@@ -519,11 +554,26 @@ class Game {
 		}
 		void removeTileToClean(Tile* tile) {
 			tilesToClean.erase(tile);
+			if (mapClean) {
+				mapClean->skippedTiles.erase(tile);
+			}
 		}
 		void clearTilesToClean() {
 			tilesToClean.clear();
 		}
 
+		// the map pager only frees a tile the game keeps no pointer into, releaseTile drops the pointers it may still hold
+		bool canReleaseTile(const Tile* tile) const;
+		// tiles an open container or a trade item of a player lies on, none of their creatures has to be in the same region
+		std::unordered_set<const Tile*> getTilesInUse() const;
+		void releaseTile(Tile* tile);
+
+		// removes cleanable items a slice of tiles per dispatcher task, false if a clean is already running
+		bool startMapClean(std::function<void(uint32_t, size_t)> callback = nullptr);
+		bool isCleaningMap() const {
+			return mapClean != nullptr;
+		}
+
 	private:
 		bool playerSaySpell(Player* player, SpeakClasses type, const std::string& text);
 		void playerWhisper(Player* player, const std::string& text);
@@ -534,6 +584,11 @@ class Game {
 		void checkDecay();
 		void internalDecayItem(Item* item);
 
+		void getCombatSpectators(SpectatorVec& spectators, const Position& pos, bool multifloor, const CombatBatch* batch);
+		void addCombatMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect, CombatBatch* batch);
+		void addCombatMagicEffect(const Position& pos, uint8_t effect, CombatBatch* batch);
+		void sendCombatTextMessage(Player* player, const TextMessage& message, CombatBatch* batch);
+
 		std::unordered_map<uint32_t, Player*> players;
 		std::unordered_map<std::string, Player*> mappedPlayerNames;
 		std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
@@ -561,6 +616,19 @@ class Game {
 
 		std::unordered_set<Tile*> tilesToClean;
 
+		struct MapClean {
+			std::function<void(uint32_t, size_t)> callback;
+			std::unordered_set<Tile*> skippedTiles;
+			size_t remainingTiles = 0;
+			size_t tiles = 0;
+			uint32_t items = 0;
+			int64_t start = 0;
+			int64_t longestSlice = 0;
+		};
+
+		void cleanMapSlice();
+		std::unique_ptr<MapClean> mapClean;
+
 		ModalWindow offlineTrainingWindow { std::numeric_limits<uint32_t>::max(), "Choose a Skill", "Please choose a skill:" };
 
 		static constexpr uint8_t LIGHT_DAY = 250;
@@ -587,6 +655,23 @@ class Game {
 		void updatePlayersRecord() const;
 		uint32_t playersRecord = 0;
 
+		void saveGameStateAsync();
+		std::unordered_map<uint32_t, uint32_t> pendingPlayerSaves;
+		std::unordered_map<uint32_t, uint32_t> lastOfflinePlayerSaves;
+		std::multiset<uint32_t> playerLoads;
+		uint32_t playerSaveSequence = 0;
+		uint32_t pendingServerSaves = 0;
+
+		void savePlayerRolling(Player* player);
+		void schedulePlayerSave(uint32_t playerId, int64_t due);
+		std::set<std::pair<int64_t, uint32_t>> playerSaveQueue; // time the save is due, player id
+		std::unordered_map<uint32_t, int64_t> playerSaveDue;
+		std::deque<std::pair<uint32_t, int64_t>> prioritySaveQueue; // player id, time the save was requested
+		std::unordered_set<uint32_t> prioritySaves;
+		int64_t playerSaveDelay = 0;
+		int64_t lastPlayerSaveReport = 0;
+		uint32_t playerSavesSinceReport = 0;
+
 		std::string motdHash;
 		uint32_t motdNum = 0;
 };
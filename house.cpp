@@ -43,7 +43,7 @@ void House::setOwner(uint32_t guid, bool updateDatabase/* = true*/, Player* play
 		}
 
 		for (HouseTile* tile : houseTiles) {
-			if (const CreatureVector* creatures = tile->getCreatures()) {
+			if (const TileCreatureVector* creatures = tile->getCreatures()) {
 				for (int32_t i = creatures->size(); --i >= 0;) {
 					kickPlayer(nullptr, (*creatures)[i]->getPlayer());
 				}
@@ -174,7 +174,7 @@ void House::setAccessList(uint32_t listId, std::string_view textlist) {
 
 	//kick uninvited players
 	for (HouseTile* tile : houseTiles) {
-		if (CreatureVector* creatures = tile->getCreatures()) {
+		if (TileCreatureVector* creatures = tile->getCreatures()) {
 			for (int32_t i = creatures->size(); --i >= 0;) {
 				Player* player = (*creatures)[i]->getPlayer();
 				if (player && !isInvited(player)) {
@@ -542,44 +542,65 @@ House* Houses::getHouseByPlayerId(uint32_t playerId) {
 	return nullptr;
 }
 
-bool Houses::loadHousesXML(const std::string& filename) {
+std::optional<std::vector<HouseRecord>> Houses::parseHousesXML(const std::string& filename) {
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file(filename.c_str());
 	if (!result) {
 		printXMLError("Error - Houses::loadHousesXML", filename, result);
-		return false;
+		return std::nullopt;
 	}
 
+	std::vector<HouseRecord> houses;
 	for (auto houseNode : doc.child("houses").children()) {
+		HouseRecord& house = houses.emplace_back();
 		pugi::xml_attribute houseIdAttribute = houseNode.attribute("houseid");
 		if (!houseIdAttribute) {
-			return false;
+			house.hasId = false;
+			break;
 		}
 
-		int32_t houseId = pugi::cast<int32_t>(houseIdAttribute.value());
+		house.id = pugi::cast<int32_t>(houseIdAttribute.value());
+		house.name = houseNode.attribute("name").as_string();
+		house.entryPos = Position(
+			pugi::cast<uint16_t>(houseNode.attribute("entryx").value()),
+			pugi::cast<uint16_t>(houseNode.attribute("entryy").value()),
+			pugi::cast<uint16_t>(houseNode.attribute("entryz").value())
+		);
+		house.rent = pugi::cast<uint32_t>(houseNode.attribute("rent").value());
+		house.townId = pugi::cast<uint32_t>(houseNode.attribute("townid").value());
+	}
+	return houses;
+}
+
+bool Houses::loadHousesXML(const std::string& filename) {
+	std::optional<std::vector<HouseRecord>> houses = parseHousesXML(filename);
+	return houses && loadHouses(*houses);
+}
+
+bool Houses::loadHouses(const std::vector<HouseRecord>& houses) {
+	for (const HouseRecord& record : houses) {
+		if (!record.hasId) {
+			return false;
+		}
 
-		House* house = getHouse(houseId);
+		House* house = getHouse(record.id);
 		if (!house) {
-			std::cout << "Error: [Houses::loadHousesXML] Unknown house, id = " << houseId << std::endl;
+			std::cout << "Error: [Houses::loadHousesXML] Unknown house, id = " << record.id << std::endl;
 			return false;
 		}
 
-		house->setName(houseNode.attribute("name").as_string());
+		house->setName(record.name);
 
-		Position entryPos(
-			pugi::cast<uint16_t>(houseNode.attribute("entryx").value()),
-			pugi::cast<uint16_t>(houseNode.attribute("entryy").value()),
-			pugi::cast<uint16_t>(houseNode.attribute("entryz").value())
-		);
+		const Position& entryPos = record.entryPos;
 		if (entryPos.x == 0 && entryPos.y == 0 && entryPos.z == 0) {
 			std::cout << "[Warning - Houses::loadHousesXML] House entry not set"
 					    << " - Name: " << house->getName()
-					    << " - House id: " << houseId << std::endl;
+					    << " - House id: " << record.id << std::endl;
 		}
 		house->setEntryPos(entryPos);
 
-		house->setRent(pugi::cast<uint32_t>(houseNode.attribute("rent").value()));
-		house->setTownId(pugi::cast<uint32_t>(houseNode.attribute("townid").value()));
+		house->setRent(record.rent);
+		house->setTownId(record.townId);
 
 		house->setOwner(0, false);
 	}
@@ -206,6 +206,27 @@ class House {
 			return static_cast<uint32_t>(std::ceil(bedsList.size() / 2.)); //each bed takes 2 sqms of space, ceil is just for bad maps
 		}
 
+		// bumped on every item change in the house, saves only rewrite the houses with unsaved changes
+		void onItemChange() {
+			++itemRevision;
+		}
+		uint32_t getItemRevision() const {
+			return itemRevision;
+		}
+		// decaying items change their duration on every decay pass without bumping the revision
+		bool hasUnsavedItems() const {
+			return decayingItems != 0 || itemRevision != savedItemRevision;
+		}
+		void resetDecayingItems() {
+			decayingItems = 0;
+		}
+		void addDecayingItem() {
+			++decayingItems;
+		}
+		void setSavedItemRevision(uint32_t revision) {
+			savedItemRevision = revision;
+		}
+
 	private:
 		bool transferToDepot() const;
 		bool transferToDepot(Player* player) const;
@@ -232,6 +253,9 @@ class House {
 		uint32_t rentWarnings = 0;
 		uint32_t rent = 0;
 		uint32_t townId = 0;
+		uint32_t itemRevision = 0;
+		uint32_t savedItemRevision = 0;
+		uint32_t decayingItems = 0;
 
 		Position posEntry = {};
 
@@ -248,6 +272,17 @@ enum RentPeriod_t {
 	RENTPERIOD_NEVER,
 };
 
+// a house as written in the house file, so it can be cached with the map
+struct HouseRecord {
+	std::string name;
+	Position entryPos;
+	uint32_t rent = 0;
+	uint32_t townId = 0;
+	int32_t id = 0;
+	// the file is only read up to the first house without an id
+	bool hasId = true;
+};
+
 class Houses {
 	public:
 		Houses() = default;
@@ -282,7 +317,10 @@ class Houses {
 
 		House* getHouseByPlayerId(uint32_t playerId);
 
+		static std::optional<std::vector<HouseRecord>> parseHousesXML(const std::string& filename);
+
 		bool loadHousesXML(const std::string& filename);
+		bool loadHouses(const std::vector<HouseRecord>& houses);
 
 		void payHouses(RentPeriod_t rentPeriod) const;
 
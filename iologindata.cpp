@@ -7,12 +7,14 @@
 
 #include "condition.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "depotchest.h"
 #include "game.h"
 
 #include "inbox.h"
 #include "storeinbox.h"
 
+extern Dispatcher g_dispatcher;
 extern Game g_game;
 
 std::string decodeSecret(std::string_view secret) {
@@ -43,44 +45,186 @@ std::string decodeSecret(std::string_view secret) {
 	return key;
 }
 
-std::pair<uint32_t, std::string> IOLoginData::gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime) {
-	Database& db = Database::getInstance();
+namespace {
+
+	struct AccountCacheEntry {
+		AccountLoginInfo_ptr info;
+		int64_t expiresAt;
+	};
+
+	constexpr size_t ACCOUNT_CACHE_SWEEP_SIZE = 1024;
+
+	std::mutex accountCacheLock;
+	std::unordered_map<std::string, AccountCacheEntry> accountCache;
+
+	// lower ids are the slots and depot ids a top level item names as its parent
+	constexpr uint32_t FIRST_ITEM_SID = 101;
+	constexpr uint32_t LAST_ITEM_SID = std::numeric_limits<int32_t>::max();
+	// new items leave room behind them, so items put in between later fit without renumbering their siblings
+	constexpr uint32_t ITEM_SID_SPACING = 1024;
+
+	size_t hashItemRow(int32_t pid, uint16_t type, uint16_t count, std::string_view attributes) {
+		std::string row = fmt::format("{:d}, {:d}, {:d}, ", pid, type, count);
+		row.append(attributes);
+		return std::hash<std::string>{}(row);
+	}
+
+	// the items of a container are loaded in ascending sid order, the longest run of siblings whose old sids still ascend keeps them
+	std::vector<bool> getKeptSids(const std::vector<uint32_t>& sids) {
+		constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+		std::vector<size_t> tails;
+		std::vector<size_t> previous(sids.size(), npos);
+		for (size_t i = 0; i < sids.size(); ++i) {
+			if (sids[i] == 0) {
+				continue;
+			}
+
+			auto it = std::lower_bound(tails.begin(), tails.end(), sids[i], [&sids](size_t index, uint32_t sid) { return sids[index] < sid; });
+			if (it != tails.begin()) {
+				previous[i] = *std::prev(it);
+			}
+
+			if (it == tails.end()) {
+				tails.push_back(i);
+			} else {
+				*it = i;
+			}
+		}
+
+		std::vector<bool> kept(sids.size());
+		for (size_t i = tails.empty() ? npos : tails.back(); i != npos; i = previous[i]) {
+			kept[i] = true;
+		}
+		return kept;
+	}
+
+	// numbers the siblings that did not keep their sid in the gaps between the kept ones, fails if a gap is too narrow
+	bool assignSids(std::vector<uint32_t>& sids, const std::vector<bool>& kept, std::set<uint32_t>& usedSids, uint32_t lower) {
+		size_t first = 0;
+		while (first < sids.size()) {
+			if (kept[first]) {
+				lower = sids[first++];
+				continue;
+			}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, UNHEX(`password`) AS `password`, `secret` FROM `accounts` WHERE `name` = {:s}", db.escapeString(accountName)));
+			size_t last = first;
+			while (last < sids.size() && !kept[last]) {
+				++last;
+			}
+
+			const uint64_t upper = last < sids.size() ? sids[last] : uint64_t{LAST_ITEM_SID} + 1;
+			const uint64_t spacing = std::min<uint64_t>(ITEM_SID_SPACING, (upper - lower) / (last - first + 1));
+			if (spacing == 0) {
+				return false;
+			}
+
+			uint64_t sid = lower;
+			for (size_t i = first; i < last; ++i) {
+				sid += spacing;
+				while (usedSids.contains(sid)) {
+					++sid;
+				}
+
+				if (sid + (last - i) > upper) {
+					return false;
+				}
+
+				sids[i] = static_cast<uint32_t>(sid);
+				usedSids.insert(sids[i]);
+			}
+			first = last;
+		}
+		return true;
+	}
+
+} // namespace
+
+AccountLoginInfo_ptr IOLoginData::getAccountLoginInfo(Database& db, const std::string& accountName) {
+	// account names compare case insensitive in the database
+	const std::string cacheKey = boost::algorithm::to_lower_copy(accountName);
+	const int64_t cacheTime = static_cast<int64_t>(getNumber(ConfigManager::LOGIN_CACHE_TIME)) * 1000;
+	if (cacheTime > 0) {
+		std::lock_guard<std::mutex> lockClass(accountCacheLock);
+		auto it = accountCache.find(cacheKey);
+		if (it != accountCache.end() && it->second.expiresAt > OTSYS_TIME()) {
+			return it->second.info;
+		}
+	}
+
+	DBResult_ptr result = db.storePrepared("SELECT `id`, UNHEX(`password`) AS `password`, `secret`, `premium_ends_at` FROM `accounts` WHERE `name` = ?", {accountName});
 	if (!result) {
+		return nullptr;
+	}
+
+	auto info = std::make_shared<AccountLoginInfo>();
+	info->id = result->getNumber<uint32_t>("id");
+	info->password = result->getString("password");
+	info->secret = decodeSecret(result->getString("secret"));
+	info->premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
+
+	result = db.storePrepared("SELECT `name` FROM `players` WHERE `account_id` = ? AND `deletion` = 0 ORDER BY `name` ASC", {info->id});
+	if (result) {
+		do {
+			info->characters.emplace_back(result->getString("name"));
+		} while (result->next());
+	}
+
+	if (cacheTime > 0) {
+		const int64_t now = OTSYS_TIME();
+
+		std::lock_guard<std::mutex> lockClass(accountCacheLock);
+		if (accountCache.size() >= ACCOUNT_CACHE_SWEEP_SIZE) {
+			std::erase_if(accountCache, [now](const auto& it) { return it.second.expiresAt <= now; });
+		}
+		accountCache[cacheKey] = {info, now + cacheTime};
+	}
+	return info;
+}
+
+void IOLoginData::clearAccountLoginCache(uint32_t accountId/* = 0*/) {
+	std::lock_guard<std::mutex> lockClass(accountCacheLock);
+	if (accountId == 0) {
+		accountCache.clear();
+		return;
+	}
+
+	std::erase_if(accountCache, [accountId](const auto& it) { return it.second.info->id == accountId; });
+}
+
+std::pair<uint32_t, std::string> IOLoginData::gameworldAuthentication(Database& db, const std::string& accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime) {
+	AccountLoginInfo_ptr account = getAccountLoginInfo(db, accountName);
+	if (!account) {
 		return std::make_pair(0, std::string{characterName});
 	}
 
-	std::string secret = decodeSecret(result->getString("secret"));
-	if (!secret.empty()) {
+	if (!account->secret.empty()) {
 		if (token.empty()) {
 			return std::make_pair(0, std::string{characterName});
 		}
 
-		bool tokenValid = token == generateToken(secret, tokenTime) || token == generateToken(secret, tokenTime - 1) || token == generateToken(secret, tokenTime + 1);
+		bool tokenValid = token == generateToken(account->secret, tokenTime) || token == generateToken(account->secret, tokenTime - 1) || token == generateToken(account->secret, tokenTime + 1);
 		if (!tokenValid) {
 			return std::make_pair(0, std::string{characterName});
 		}
 	}
 
-	if (transformToSHA1(password) != result->getString("password")) {
+	if (transformToSHA1(password) != account->password) {
 		return std::make_pair(0, std::string{characterName});
 	}
 
-	uint32_t accountId = result->getNumber<uint32_t>("id");
-
-	result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `name` = {:s} AND `account_id` = {:d} AND `deletion` = 0", db.escapeString(characterName), accountId));
-	if (!result) {
-		return std::make_pair(0, std::string{characterName});
+	for (const std::string& character : account->characters) {
+		if (boost::algorithm::iequals(character, characterName)) {
+			return std::make_pair(account->id, character);
+		}
 	}
-
-	return std::make_pair(accountId, std::string{result->getString("name")});
+	return std::make_pair(0, std::string{characterName});
 }
 
 uint32_t IOLoginData::getAccountIdByPlayerName(const std::string& playerName) {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(playerName)));
+	DBResult_ptr result = db.storePrepared("SELECT `account_id` FROM `players` WHERE `name` = ?", {playerName});
 	if (!result) {
 		return 0;
 	}
@@ -90,7 +234,7 @@ uint32_t IOLoginData::getAccountIdByPlayerName(const std::string& playerName) {
 uint32_t IOLoginData::getAccountIdByPlayerId(uint32_t playerId) {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `account_id` FROM `players` WHERE `id` = {:d}", playerId));
+	DBResult_ptr result = db.storePrepared("SELECT `account_id` FROM `players` WHERE `id` = ?", {playerId});
 	if (!result) {
 		return 0;
 	}
@@ -98,7 +242,7 @@ uint32_t IOLoginData::getAccountIdByPlayerId(uint32_t playerId) {
 }
 
 AccountType_t IOLoginData::getAccountType(uint32_t accountId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `type` FROM `accounts` WHERE `id` = {:d}", accountId));
+	DBResult_ptr result = Database::getInstance().storePrepared("SELECT `type` FROM `accounts` WHERE `id` = ?", {accountId});
 	if (!result) {
 		return ACCOUNT_TYPE_NORMAL;
 	}
@@ -106,7 +250,7 @@ AccountType_t IOLoginData::getAccountType(uint32_t accountId) {
 }
 
 void IOLoginData::setAccountType(uint32_t accountId, AccountType_t accountType) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `accounts` SET `type` = {:d} WHERE `id` = {:d}", static_cast<uint16_t>(accountType), accountId));
+	Database::getInstance().executePrepared("UPDATE `accounts` SET `type` = ? WHERE `id` = ?", {static_cast<uint16_t>(accountType), accountId});
 }
 
 void IOLoginData::updateOnlineStatus(uint32_t guid, bool login) {
@@ -115,45 +259,97 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login) {
 	}
 
 	if (login) {
-		Database::getInstance().executeQuery(fmt::format("INSERT INTO `players_online` VALUES ({:d})", guid));
+		Database::getInstance().executePrepared("INSERT INTO `players_online` VALUES (?)", {guid});
 	} else {
-		Database::getInstance().executeQuery(fmt::format("DELETE FROM `players_online` WHERE `player_id` = {:d}", guid));
+		Database::getInstance().executePrepared("DELETE FROM `players_online` WHERE `player_id` = ?", {guid});
 	}
 }
 
-bool IOLoginData::preloadPlayer(Player* player, const std::string& name) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `p`.`id`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` as `p` JOIN `accounts` as `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`name` = {:s} AND `p`.`deletion` = 0", db.escapeString(name)));
-	if (!result) {
+bool IOLoginData::preloadPlayer(Player* player, const PlayerData& data) {
+	if (!data.player || !data.account) {
 		return false;
 	}
 
-	player->setGUID(result->getNumber<uint32_t>("id"));
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	player->setGUID(data.player->getNumber<uint32_t>("id"));
+	Group* group = g_game.groups.getGroup(data.player->getNumber<uint16_t>("group_id"));
 	if (!group) {
-		std::cout << "[Error - IOLoginData::preloadPlayer] " << player->name << " has Group ID " << result->getNumber<uint16_t>("group_id") << " which doesn't exist." << std::endl;
+		std::cout << "[Error - IOLoginData::preloadPlayer] " << player->name << " has Group ID " << data.player->getNumber<uint16_t>("group_id") << " which doesn't exist." << std::endl;
 		return false;
 	}
 	player->setGroup(group);
-	player->accountNumber = result->getNumber<uint32_t>("account_id");
-	player->accountType = static_cast<AccountType_t>(result->getNumber<uint16_t>("type"));
-	player->premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
+	player->accountNumber = data.player->getNumber<uint32_t>("account_id");
+	player->accountType = static_cast<AccountType_t>(data.account->getNumber<uint16_t>("type"));
+	player->premiumEndsAt = data.account->getNumber<time_t>("premium_ends_at");
+	return true;
+}
+
+bool IOLoginData::fetchPlayerPreloadData(Database& db, PlayerData& data, const std::string& name) {
+	data.player = db.storePrepared("SELECT `id`, `account_id`, `group_id` FROM `players` WHERE `name` = ? AND `deletion` = 0", {name});
+	if (!data.player) {
+		return false;
+	}
+
+	data.account = db.storePrepared("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = ?", {data.player->getNumber<uint32_t>("account_id")});
+	return data.account != nullptr;
+}
+
+bool IOLoginData::fetchPlayerDataById(Database& db, PlayerData& data, uint32_t id) {
+	data.player = db.storePrepared("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = ?", {id});
+	return fetchPlayerData(db, data);
+}
+
+bool IOLoginData::fetchPlayerDataByName(Database& db, PlayerData& data, const std::string& name) {
+	data.player = db.storePrepared("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = ? AND `deletion` = 0", {name});
+	return fetchPlayerData(db, data);
+}
+
+bool IOLoginData::fetchPlayerData(Database& db, PlayerData& data) {
+	if (!data.player) {
+		return false;
+	}
+
+	data.account = db.storePrepared("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = ?", {data.player->getNumber<uint32_t>("account_id")});
+	if (!data.account) {
+		return false;
+	}
+
+	const uint32_t guid = data.player->getNumber<uint32_t>("id");
+	if ((data.guildMembership = db.storePrepared("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = ?", {guid}))) {
+		const uint32_t guildId = data.guildMembership->getNumber<uint32_t>("guild_id");
+		data.guildRank = db.storePrepared("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = ?", {data.guildMembership->getNumber<uint32_t>("rank_id")});
+		data.guildWars = db.storePrepared("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = ? OR `guild2` = ?) AND `ended` = 0 AND `status` = 1", {guildId, guildId});
+		data.guildMembers = db.storePrepared("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = ?", {guildId});
+	}
+
+	data.spells = db.storePrepared("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = ?", {guid});
+	data.items = db.storePrepared("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = ? ORDER BY `sid` DESC", {guid});
+	data.depotItems = db.storePrepared("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = ? ORDER BY `sid` DESC", {guid});
+	data.inboxItems = db.storePrepared("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC", {guid});
+	data.storeInboxItems = db.storePrepared("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC", {guid});
+	data.storage = db.storePrepared("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?", {guid});
+	data.vipList = db.storePrepared("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = ?", {data.player->getNumber<uint32_t>("account_id")});
+	data.outfits = db.storePrepared("SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = ?", {guid});
+	data.mounts = db.storePrepared("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = ?", {guid});
 	return true;
 }
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id) {
-	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}", id)));
+	PlayerData data;
+	if (!fetchPlayerDataById(Database::getInstance(), data, id)) {
+		return false;
+	}
+	return loadPlayer(player, data);
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name) {
-	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}", db.escapeString(name))));
+	PlayerData data;
+	if (!fetchPlayerDataByName(Database::getInstance(), data, name)) {
+		return false;
+	}
+	return loadPlayer(player, data);
 }
 
-static GuildWarVector getWarList(uint32_t guildId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1", guildId, guildId));
+static GuildWarVector getWarList(uint32_t guildId, DBResult_ptr result) {
 	if (!result) {
 		return {};
 	}
@@ -171,21 +367,16 @@ static GuildWarVector getWarList(uint32_t guildId) {
 	return guildWarVector;
 }
 
-bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
-	if (!result) {
+bool IOLoginData::loadPlayer(Player* player, const PlayerData& data) {
+	if (!data.player || !data.account) {
 		return false;
 	}
 
-	Database& db = Database::getInstance();
+	DBResult_ptr result = data.player;
+	const DBResult_ptr& account = data.account;
 
 	uint32_t accountId = result->getNumber<uint32_t>("account_id");
 
-	auto account =
-	    db.storeQuery(fmt::format("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accountId));
-	if (!account) {
-		return false;
-	}
-
 	player->setGUID(result->getNumber<uint32_t>("id"));
 	player->name = result->getString("name");
 	player->accountNumber = accountId;
@@ -326,7 +517,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		player->skills[i].percent = Player::getPercentLevel(skillTries, nextSkillTries);
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.guildMembership)) {
 		uint32_t guildId = result->getNumber<uint32_t>("guild_id");
 		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
 		player->guildNick = result->getString("nick");
@@ -345,7 +536,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 			player->guild = guild;
 			auto rank = guild->getRankById(playerRankId);
 			if (!rank) {
-				if ((result = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", playerRankId)))) {
+				if ((result = data.guildRank)) {
 					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), result->getNumber<uint16_t>("level"));
 				}
 
@@ -356,25 +547,41 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 			}
 
 			player->guildRank = rank;
-			player->guildWarVector = getWarList(guildId);
+			player->guildWarVector = getWarList(guildId, data.guildWars);
 
-			if ((result = db.storeQuery(fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
+			if ((result = data.guildMembers)) {
 				guild->setMemberCount(result->getNumber<uint32_t>("members"));
 			}
 		}
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID())))) {
+	// the rows each table holds now, the first save only writes what differs from them
+	Database& db = Database::getInstance();
+	for (std::string_view table : {"player_spells", "player_items", "player_storeinboxitems", "player_outfits", "player_mounts"}) {
+		player->savedRows[table];
+	}
+	if (!data.depotItems) {
+		player->savedRows["player_depotitems"];
+	}
+	if (!data.inboxItems) {
+		player->savedRows["player_inboxitems"];
+	}
+
+	if ((result = data.spells)) {
+		auto& savedRows = player->savedRows["player_spells"];
 		do {
-			player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			auto name = result->getString("name");
+			std::string key = db.escapeString(name);
+			savedRows.emplace(key, std::hash<std::string>{}(fmt::format("{:d}, {:s}", player->getGUID(), key)));
+			player->learnedInstantSpellList.emplace_front(name);
 		} while (result->next());
 	}
 
 	//load inventory items
 	ItemMap itemMap;
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+	if ((result = data.items)) {
+		loadItems(itemMap, result, player->savedRows["player_items"], player->itemSids["player_items"]);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
 			const std::pair<Item*, int32_t>& pair = it->second;
@@ -396,69 +603,15 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		}
 	}
 
-	//load depot items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-
-			int32_t pid = pair.second;
-			if (pid >= 0 && pid < 100) {
-				const auto& depotChest = player->getDepotChest(pid, true);
-				if (depotChest) {
-					depotChest->internalAddThing(item);
-				}
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	//load inbox items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-
-			if (pid >= 0 && pid < 100) {
-				player->getInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
+	// depot and inbox rows are turned into items the first time the player uses them
+	player->pendingDepotItems = data.depotItems;
+	player->pendingInboxItems = data.inboxItems;
 
 	//load store inbox items
 	itemMap.clear();
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+	if ((result = data.storeInboxItems)) {
+		loadItems(itemMap, result, player->savedRows["player_storeinboxitems"], player->itemSids["player_storeinboxitems"]);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
 			const std::pair<Item*, int32_t>& pair = it->second;
@@ -483,32 +636,44 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 	}
 
 	//load storage map
-	if ((result = db.storeQuery(fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.storage)) {
 		do {
-			player->setStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
+			const uint32_t key = result->getNumber<uint32_t>("key");
+			const int32_t value = result->getNumber<int32_t>("value");
+			player->setStorageValue(key, value, true);
+
+			// the row is already stored unless onUpdateStorage changed it
+			if (player->getStorageValue(key) == value) {
+				player->clearDirtyStorageKey(key);
+			}
 		} while (result->next());
 	}
 
 	//load vip list
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}", player->getAccount())))) {
+	if ((result = data.vipList)) {
 		do {
 			player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
 		} while (result->next());
 	}
 
 	// load outfits & addons
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.outfits)) {
+		auto& savedRows = player->savedRows["player_outfits"];
 		do {
-			player->addOutfit(result->getNumber<uint16_t>("outfit_id"), result->getNumber<uint8_t>("addons"));
+			uint16_t outfitId = result->getNumber<uint16_t>("outfit_id");
+			uint8_t addons = result->getNumber<uint8_t>("addons");
+			savedRows.emplace(std::to_string(outfitId), std::hash<std::string>{}(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), outfitId, addons)));
+			player->addOutfit(outfitId, addons);
 		} while (result->next());
 	}
 
 	// load mounts
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.mounts)) {
+		auto& savedRows = player->savedRows["player_mounts"];
 		do {
-			player->tameMount(result->getNumber<uint16_t>("mount_id"));
+			uint16_t mountId = result->getNumber<uint16_t>("mount_id");
+			savedRows.emplace(std::to_string(mountId), std::hash<std::string>{}(fmt::format("{:d}, {:d}", player->getGUID(), mountId)));
+			player->tameMount(mountId);
 		} while (result->next());
 	}
 
@@ -518,71 +683,317 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 	return true;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream) {
-	using ContainerBlock = std::pair<Container*, int32_t>;
-	std::vector<ContainerBlock> containers;
-	containers.reserve(32);
-
-	int32_t runningId = 100;
+void IOLoginData::serializeItems(Player* player, std::string_view table, const ItemBlockList& itemList, TableRows& rows, PropWriteStream& propWriteStream) {
+	// the items that share a parent in their order, top level items are grouped by their slot or depot id
+	struct SiblingBlock {
+		const Item* parent = nullptr;
+		int32_t pid = 0;
+		std::vector<Item*> items;
+	};
 
-	Database& db = Database::getInstance();
+	std::vector<SiblingBlock> blocks;
 	for (const auto& it : itemList) {
-		int32_t pid = it.first;
-		Item* item = it.second;
-		++runningId;
+		if (blocks.empty() || blocks.back().pid != it.first) {
+			blocks.emplace_back().pid = it.first;
+		}
+		blocks.back().items.push_back(it.second);
+	}
+
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		for (size_t j = 0; j < blocks[i].items.size(); ++j) {
+			Item* item = blocks[i].items[j];
+			if (const Container* container = item->getContainer(); container && !container->empty()) {
+				SiblingBlock& block = blocks.emplace_back();
+				block.parent = item;
+				block.items.assign(container->getItemList().begin(), container->getItemList().end());
+			}
+		}
+	}
 
-		propWriteStream.clear();
-		item->serializeAttr(propWriteStream);
+	// items keep their sid from save to save, so adding, moving or changing an item only rewrites its own row
+	auto& itemSids = player->itemSids[table];
 
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
-			return false;
+	std::vector<std::vector<uint32_t>> sids(blocks.size());
+	std::vector<std::vector<bool>> kept(blocks.size());
+	std::set<uint32_t> usedSids;
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		for (const Item* item : blocks[i].items) {
+			auto it = itemSids.find(item);
+			sids[i].push_back(it != itemSids.end() ? it->second : 0);
 		}
 
-		if (Container* container = item->getContainer()) {
-			containers.emplace_back(container, runningId);
+		kept[i] = getKeptSids(sids[i]);
+		for (size_t j = 0; j < sids[i].size(); ++j) {
+			if (kept[i][j]) {
+				usedSids.insert(sids[i][j]);
+			}
 		}
 	}
 
-	for (size_t i = 0; i < containers.size(); i++) {
-		const ContainerBlock& cb = containers[i];
-		Container* container = cb.first;
-		int32_t parentId = cb.second;
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		if (assignSids(sids[i], kept[i], usedSids, FIRST_ITEM_SID - 1)) {
+			continue;
+		}
 
-		for (Item* item : container->getItemList()) {
-			++runningId;
+		// no room left in between, the whole block is numbered after the highest sid
+		kept[i].assign(kept[i].size(), false);
+		if (!assignSids(sids[i], kept[i], usedSids, usedSids.empty() ? FIRST_ITEM_SID - 1 : *usedSids.rbegin())) {
+			// the sids ran out, every item of the table is numbered anew
+			itemSids.clear();
+			serializeItems(player, table, itemList, rows, propWriteStream);
+			return;
+		}
+	}
 
-			Container* subContainer = item->getContainer();
-			if (subContainer) {
-				containers.emplace_back(subContainer, runningId);
-			}
+	std::unordered_map<const Item*, uint32_t> newSids;
+	newSids.reserve(usedSids.size());
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		for (size_t j = 0; j < blocks[i].items.size(); ++j) {
+			newSids.emplace(blocks[i].items[j], sids[i][j]);
+		}
+	}
+
+	// unchanged rows are only hashed, the values are formatted for the rows that are written
+	Database& db = Database::getInstance();
+	const auto* savedRows = getSavedRows(player, table);
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		const SiblingBlock& block = blocks[i];
+		const int32_t pid = block.parent ? static_cast<int32_t>(newSids[block.parent]) : block.pid;
+		for (size_t j = 0; j < block.items.size(); ++j) {
+			const Item* item = block.items[j];
+			const int32_t sid = static_cast<int32_t>(sids[i][j]);
 
 			propWriteStream.clear();
 			item->serializeAttr(propWriteStream);
 
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
-				return false;
+			TableRow& row = rows.emplace_back();
+			row.key = std::to_string(sid);
+			row.hash = hashItemRow(pid, item->getID(), item->getSubType(), propWriteStream.getStream());
+			if (savedRows) {
+				if (auto it = savedRows->find(row.key); it != savedRows->end() && it->second == row.hash) {
+					continue;
+				}
+			}
+			row.values = fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, sid, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream()));
+		}
+	}
+
+	itemSids = std::move(newSids);
+}
+
+void IOLoginData::loadDepotItems(Player* player, DBResult_ptr result) {
+	ItemMap itemMap;
+	loadItems(itemMap, result, player->savedRows["player_depotitems"], player->itemSids["player_depotitems"]);
+
+	for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+		const std::pair<Item*, int32_t>& pair = it->second;
+		Item* item = pair.first;
+
+		int32_t pid = pair.second;
+		if (pid >= 0 && pid < 100) {
+			const auto& depotChest = player->getDepotChest(pid, true);
+			if (depotChest) {
+				depotChest->internalAddThing(item);
+			}
+		} else {
+			ItemMap::const_iterator it2 = itemMap.find(pid);
+			if (it2 == itemMap.end()) {
+				continue;
+			}
+
+			Container* container = it2->second.first->getContainer();
+			if (container) {
+				container->internalAddThing(item);
+			}
+		}
+	}
+}
+
+void IOLoginData::loadInboxItems(Player* player, DBResult_ptr result) {
+	ItemMap itemMap;
+	loadItems(itemMap, result, player->savedRows["player_inboxitems"], player->itemSids["player_inboxitems"]);
+
+	for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+		const std::pair<Item*, int32_t>& pair = it->second;
+		Item* item = pair.first;
+		int32_t pid = pair.second;
+
+		if (pid >= 0 && pid < 100) {
+			player->getInbox()->internalAddThing(item);
+		} else {
+			ItemMap::const_iterator it2 = itemMap.find(pid);
+
+			if (it2 == itemMap.end()) {
+				continue;
+			}
+
+			Container* container = it2->second.first->getContainer();
+			if (container) {
+				container->internalAddThing(item);
+			}
+		}
+	}
+}
+
+const std::unordered_map<std::string, size_t>* IOLoginData::getSavedRows(const Player* player, std::string_view table) {
+	// the rows a queued save leaves behind are not known yet, so the table is written as a whole
+	if (g_game.hasPendingPlayerSave(player->getGUID())) {
+		return nullptr;
+	}
+
+	auto it = player->savedRows.find(table);
+	return it != player->savedRows.end() ? &it->second : nullptr;
+}
+
+void IOLoginData::serializeRows(const Player* player, std::string_view table, std::string_view columns, std::string_view keyColumn, const TableRows& rows, PlayerSaveData& data) {
+	const auto* savedRows = getSavedRows(player, table);
+
+	std::unordered_map<std::string, size_t> writtenRows;
+	writtenRows.reserve(rows.size());
+
+	std::string removedKeys;
+	auto removeKey = [&removedKeys](std::string_view key) {
+		if (!removedKeys.empty()) {
+			removedKeys.push_back(',');
+		}
+		removedKeys.append(key);
+	};
+
+	// rows whose key is new or whose values changed are inserted, changed and vanished keys are deleted first
+	std::vector<const std::string*> insertedRows;
+	for (const TableRow& row : rows) {
+		writtenRows.emplace(row.key, row.hash);
+
+		if (savedRows) {
+			if (auto it = savedRows->find(row.key); it != savedRows->end()) {
+				if (it->second == row.hash) {
+					continue;
+				}
+				removeKey(row.key);
+			}
+		}
+		insertedRows.push_back(&row.values);
+	}
+
+	if (!savedRows) {
+		data.statements.push_back(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d}", table, player->getGUID()));
+	} else {
+		for (const auto& it : *savedRows) {
+			if (!writtenRows.contains(it.first)) {
+				removeKey(it.first);
 			}
 		}
+
+		if (removedKeys.empty() && insertedRows.empty()) {
+			return;
+		}
+
+		if (!removedKeys.empty()) {
+			data.statements.push_back(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d} AND `{:s}` IN ({:s})", table, player->getGUID(), keyColumn, removedKeys));
+		}
 	}
-	return query_insert.execute();
+
+	DBInsert query(fmt::format("INSERT INTO `{:s}` ({:s}) VALUES ", table, columns), data.statements);
+	for (const std::string* row : insertedRows) {
+		query.addRow(*row);
+	}
+	query.execute();
+
+	data.rows[table] = std::move(writtenRows);
 }
 
 bool IOLoginData::savePlayer(Player* player) {
-	if (player->isDead()) {
-		player->changeHealth(1);
+	// keep the order with the writes still queued for this player, and report the result of this one
+	if (g_game.hasPendingPlayerSave(player->getGUID())) {
+		auto data = savePlayerAsync(player);
+		g_databaseTasks.flush(getPlayerTaskKey(player->getGUID()));
+		return data->saved;
 	}
 
-	Database& db = Database::getInstance();
+	PlayerSaveData data;
+	serializePlayer(player, data);
+	if (!writePlayer(Database::getInstance(), data)) {
+		return false;
+	}
+
+	if (data.offline) {
+		g_game.addOfflinePlayerSave(data.guid);
+	}
+	onPlayerSaved(player, data);
+	return true;
+}
+
+std::shared_ptr<const PlayerSaveData> IOLoginData::savePlayerAsync(Player* player) {
+	auto data = std::make_shared<PlayerSaveData>();
+	serializePlayer(player, *data);
+
+	g_game.addPendingPlayerSave(data->guid);
+	g_databaseTasks.addTask([data](Database& db) {
+		bool saved = false;
+		for (uint32_t tries = 0; tries < 3 && !saved; tries++) {
+			saved = writePlayer(db, *data);
+		}
+
+		g_dispatcher.addTask([data, saved]() {
+			g_game.removePendingPlayerSave(data->guid, data->offline);
+			if (!saved) {
+				std::cout << "[Error - IOLoginData::savePlayerAsync] Failed to save player with GUID " << data->guid << std::endl;
+				return;
+			}
+
+			onPlayerSaved(data->offline ? nullptr : g_game.getPlayerByGUID(data->guid), *data);
+		});
+	}, getPlayerTaskKey(data->guid));
+	return data;
+}
+
+bool IOLoginData::writePlayer(Database& db, PlayerSaveData& data) {
+	data.saved = data.statementsWritten = false;
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
+	DBResult_ptr result = db.storePrepared("SELECT `save` FROM `players` WHERE `id` = ?", {data.guid});
 	if (!result) {
 		return false;
 	}
 
 	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}",player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()));
+		data.saved = db.executeQuery(data.lastLoginQuery);
+	} else {
+		data.saved = data.statementsWritten = db.executeTransaction(data.statements);
+	}
+	return data.saved;
+}
+
+void IOLoginData::onPlayerSaved(Player* player, const PlayerSaveData& data) {
+	// tables that were not written stay dirty
+	if (!player || !data.statementsWritten) {
+		return;
+	}
+
+	// keys changed again after the snapshot stay dirty
+	for (const auto& [key, value] : data.storage) {
+		if (player->getStorageValue(key) == value) {
+			player->clearDirtyStorageKey(key);
+		}
 	}
 
+	for (const auto& [table, rows] : data.rows) {
+		player->savedRows[table] = rows;
+	}
+}
+
+void IOLoginData::serializePlayer(Player* player, PlayerSaveData& data) {
+	if (player->isDead()) {
+		player->changeHealth(1);
+	}
+
+	Database& db = Database::getInstance();
+
+	data.guid = player->getGUID();
+	data.offline = player->isOffline();
+
+	// written alone when the `save` column of the player is 0
+	data.lastLoginQuery = fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}", player->lastLoginSaved, player->lastIP.to_string(), player->getGUID());
+
 	//serialize conditions
 	PropWriteStream propWriteStream;
 	for (Condition* condition : player->conditions) {
@@ -678,38 +1089,21 @@ bool IOLoginData::savePlayer(Player* player) {
 	query << "`blessings` = " << player->blessings.to_ulong();
 	query << " WHERE `id` = " << player->getGUID();
 
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
+	data.statements.push_back(query.str());
 
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
+	// only the rows that changed since the last save are rewritten
+	TableRows rows;
 
 	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ");
 	for (const std::string& spellName : player->learnedInstantSpellList) {
-		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
-			return false;
-		}
+		std::string name = db.escapeString(spellName);
+		std::string row = fmt::format("{:d}, {:s}", player->getGUID(), name);
+		rows.emplace_back(std::move(name), std::move(row));
 	}
 
-	if (!spellsQuery.execute()) {
-		return false;
-	}
+	serializeRows(player, "player_spells", "`player_id`, `name`", "name", rows, data);
 
 	//item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
 		Item* item = player->inventory[slotId];
@@ -718,17 +1112,13 @@ bool IOLoginData::savePlayer(Player* player) {
 		}
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
-		return false;
-	}
+	rows.clear();
+	serializeItems(player, "player_items", itemList, rows, propWriteStream);
+	serializeRows(player, "player_items", "`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`", "sid", rows, data);
 
-	if (player->lastDepotId != -1) {
+	// a depot that was never opened still matches its rows
+	if (player->lastDepotId != -1 && !player->pendingDepotItems) {
 		//save depot items
-		if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-			return false;
-		}
-
-		DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
 		itemList.clear();
 
 		for (const auto& it : player->depotChests) {
@@ -737,99 +1127,80 @@ bool IOLoginData::savePlayer(Player* player) {
 			}
 		}
 
-		if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-			return false;
-		}
+		rows.clear();
+		serializeItems(player, "player_depotitems", itemList, rows, propWriteStream);
+		serializeRows(player, "player_depotitems", "`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`", "sid", rows, data);
 	}
 
 	//save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	if (player->inbox && !player->pendingInboxItems) {
+		itemList.clear();
 
-	for (Item* item : player->getInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
+		for (Item* item : player->inbox->getItemList()) {
+			itemList.emplace_back(0, item);
+		}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
+		rows.clear();
+		serializeItems(player, "player_inboxitems", itemList, rows, propWriteStream);
+		serializeRows(player, "player_inboxitems", "`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`", "sid", rows, data);
 	}
 
 	//save store inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert storeInboxQuery("INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
 	itemList.clear();
 
 	for (Item* item : player->getStoreInbox()->getItemList()) {
 		itemList.emplace_back(0, item);
 	}
 
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
-		return false;
-	}
-
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	rows.clear();
+	serializeItems(player, "player_storeinboxitems", itemList, rows, propWriteStream);
+	serializeRows(player, "player_storeinboxitems", "`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`", "sid", rows, data);
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
+	// save only the storage keys changed since the last save
+	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", data.statements);
+	storageQuery.upsert({"value"});
 
-	for (const auto& [key, value] : player->getStorageMap()) {
-		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), key, value))) {
-			return false;
+	std::string removedStorageKeys;
+	for (uint32_t key : player->getDirtyStorageKeys()) {
+		auto value = player->getStorageValue(key);
+		data.storage.emplace_back(key, value);
+		if (value) {
+			storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), key, value.value()));
+		} else {
+			if (!removedStorageKeys.empty()) {
+				removedStorageKeys.push_back(',');
+			}
+			removedStorageKeys.append(std::to_string(key));
 		}
 	}
 
-	if (!storageQuery.execute()) {
-		return false;
-	}
+	storageQuery.execute();
 
-	// save outfits & addons
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	if (!removedStorageKeys.empty()) {
+		data.statements.push_back(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d} AND `key` IN ({:s})", player->getGUID(), removedStorageKeys));
 	}
 
-	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ");
-
+	// save outfits & addons
+	rows.clear();
 	for (const auto& it : player->outfits) {
-		if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second))) {
-			return false;
-		}
+		rows.emplace_back(std::to_string(it.first), fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second));
 	}
 
-	if (!outfitQuery.execute()) {
-		return false;
-	}
+	serializeRows(player, "player_outfits", "`player_id`, `outfit_id`, `addons`", "outfit_id", rows, data);
 
 	// save mounts
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ");
-
+	rows.clear();
 	for (const auto& it : player->mounts) {
-		if (!mountQuery.addRow(fmt::format("{:d}, {:d}", player->getGUID(), it))) {
-			return false;
-		}
+		rows.emplace_back(std::to_string(it), fmt::format("{:d}, {:d}", player->getGUID(), it));
 	}
 
-	if (!mountQuery.execute()) {
-		return false;
-	}
+	serializeRows(player, "player_mounts", "`player_id`, `mount_id`", "mount_id", rows, data);
 
-	//End the transaction
-	return transaction.commit();
 }
 
+
 std::string IOLoginData::getNameByGuid(uint32_t guid) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `id` = {:d}", guid));
+	DBResult_ptr result = Database::getInstance().storePrepared("SELECT `name` FROM `players` WHERE `id` = ?", {guid});
 	if (!result) {
 		return {};
 	}
@@ -841,7 +1212,7 @@ std::string IOLoginData::getNameByGuid(uint32_t guid) {
 uint32_t IOLoginData::getGuidByName(const std::string& name) {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result = db.storePrepared("SELECT `id` FROM `players` WHERE `name` = ?", {name});
 	if (!result) {
 		return 0;
 	}
@@ -851,7 +1222,7 @@ uint32_t IOLoginData::getGuidByName(const std::string& name) {
 bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name) {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name`, `id`, `group_id`, `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result = db.storePrepared("SELECT `name`, `id`, `group_id`, `account_id` FROM `players` WHERE `name` = ?", {name});
 	if (!result) {
 		return false;
 	}
@@ -874,7 +1245,7 @@ bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string&
 bool IOLoginData::formatPlayerName(std::string& name) {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result = db.storePrepared("SELECT `name` FROM `players` WHERE `name` = ?", {name});
 	if (!result) {
 		return false;
 	}
@@ -883,14 +1254,23 @@ bool IOLoginData::formatPlayerName(std::string& name) {
 	return true;
 }
 
-void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result) {
+void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result, std::unordered_map<std::string, size_t>& savedRows, std::unordered_map<const Item*, uint32_t>& itemSids) {
+	const size_t sidColumn = result->getColumnIndex("sid");
+	const size_t pidColumn = result->getColumnIndex("pid");
+	const size_t itemtypeColumn = result->getColumnIndex("itemtype");
+	const size_t countColumn = result->getColumnIndex("count");
+	const size_t attributesColumn = result->getColumnIndex("attributes");
+
 	do {
-		uint32_t sid = result->getNumber<uint32_t>("sid");
-		uint32_t pid = result->getNumber<uint32_t>("pid");
-		uint16_t type = result->getNumber<uint16_t>("itemtype");
-		uint16_t count = result->getNumber<uint16_t>("count");
+		uint32_t sid = result->getNumber<uint32_t>(sidColumn);
+		uint32_t pid = result->getNumber<uint32_t>(pidColumn);
+		uint16_t type = result->getNumber<uint16_t>(itemtypeColumn);
+		uint16_t count = result->getNumber<uint16_t>(countColumn);
+
+		auto attr = result->getString(attributesColumn);
 
-		auto attr = result->getString("attributes");
+		// the rows as serializeItems hashes them, rows of items that fail to load are deleted by the next save
+		savedRows.emplace(std::to_string(sid), hashItemRow(pid, type, count, attr));
 
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
@@ -903,23 +1283,24 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result) {
 
 			std::pair<Item*, uint32_t> pair(item, pid);
 			itemMap[sid] = pair;
+			itemSids[item] = sid;
 		}
 	} while (result->next());
 }
 
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
+	Database::getInstance().executePrepared("UPDATE `players` SET `balance` = `balance` + ? WHERE `id` = ?", {bankBalance, guid});
 }
 
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid) {
 	Database& db = Database::getInstance();
-	return db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `highest_bidder` = {:d} LIMIT 1", guid)).get();
+	return db.storePrepared("SELECT `id` FROM `houses` WHERE `highest_bidder` = ? LIMIT 1", {guid}).get();
 }
 
 std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId) {
 	std::forward_list<VIPEntry> entries;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = {:d}", accountId));
+	DBResult_ptr result = Database::getInstance().storePrepared("SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = ?", {accountId});
 	if (result) {
 		do {
 			entries.emplace_front(
@@ -936,18 +1317,25 @@ std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId) {
 
 void IOLoginData::addVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon, bool notify) {
 	Database& db = Database::getInstance();
-	db.executeQuery(fmt::format("INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES ({:d}, {:d}, {:s}, {:d}, {:d})", accountId, guid, db.escapeString(description), icon, notify));
+	db.executePrepared("INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES (?, ?, ?, ?, ?)", {accountId, guid, description, icon, notify});
 }
 
 void IOLoginData::editVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon, bool notify) {
 	Database& db = Database::getInstance();
-	db.executeQuery(fmt::format("UPDATE `account_viplist` SET `description` = {:s}, `icon` = {:d}, `notify` = {:d} WHERE `account_id` = {:d} AND `player_id` = {:d}", db.escapeString(description), icon, notify, accountId, guid));
+	db.executePrepared("UPDATE `account_viplist` SET `description` = ?, `icon` = ?, `notify` = ? WHERE `account_id` = ? AND `player_id` = ?", {description, icon, notify, accountId, guid});
 }
 
 void IOLoginData::removeVIPEntry(uint32_t accountId, uint32_t guid) {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `account_viplist` WHERE `account_id` = {:d} AND `player_id` = {:d}", accountId, guid));
+	Database::getInstance().executePrepared("DELETE FROM `account_viplist` WHERE `account_id` = ? AND `player_id` = ?", {accountId, guid});
 }
 
 void IOLoginData::updatePremiumTime(uint32_t accountId, time_t endTime) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `accounts` SET `premium_ends_at` = {:d} WHERE `id` = {:d}", endTime, accountId));
+	Database::getInstance().executePrepared("UPDATE `accounts` SET `premium_ends_at` = ? WHERE `id` = ?", {endTime, accountId});
+	clearAccountLoginCache(accountId);
+}
+
+bool IOLoginData::setAccountPassword(uint32_t accountId, std::string_view password) {
+	bool updated = Database::getInstance().executePrepared("UPDATE `accounts` SET `password` = HEX(?) WHERE `id` = ?", {transformToSHA1(password), accountId});
+	clearAccountLoginCache(accountId);
+	return updated;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #ifndef FS_IOLOGINDATA_H
 #define FS_IOLOGINDATA_H
 
+#include "ban.h"
 #include "database.h"
 #include "enums.h"
 
@@ -15,21 +16,82 @@ using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
 struct VIPEntry;
 
+// rows of a player fetched by a database thread, materialized into a Player on the dispatcher
+struct PlayerData {
+	DBResult_ptr player;
+	DBResult_ptr account;
+	DBResult_ptr guildMembership;
+	DBResult_ptr guildRank;
+	DBResult_ptr guildWars;
+	DBResult_ptr guildMembers;
+	DBResult_ptr spells;
+	DBResult_ptr items;
+	DBResult_ptr depotItems;
+	DBResult_ptr inboxItems;
+	DBResult_ptr storeInboxItems;
+	DBResult_ptr storage;
+	DBResult_ptr vipList;
+	DBResult_ptr outfits;
+	DBResult_ptr mounts;
+
+	// only fetched for logins
+	bool namelocked = false;
+	std::optional<IOBan::BanInfo> banInfo;
+};
+
+// statements of a player save, serialized on the dispatcher so they can be written from any connection
+struct PlayerSaveData {
+	uint32_t guid = 0;
+	bool offline = false;
+
+	std::string lastLoginQuery;
+	std::vector<std::string> statements;
+
+	// state applied to the player once the statements are committed
+	std::map<std::string_view, std::unordered_map<std::string, size_t>> rows;
+	std::vector<std::pair<uint32_t, std::optional<int32_t>>> storage;
+
+	// outcome of writePlayer, the statements are skipped while the `save` column is 0
+	bool saved = false;
+	bool statementsWritten = false;
+};
+
+// what the login servers need to know of an account, cached for loginCacheTime seconds
+struct AccountLoginInfo {
+	uint32_t id = 0;
+	std::string password;
+	std::string secret;
+	time_t premiumEndsAt = 0;
+	std::vector<std::string> characters;
+};
+
+using AccountLoginInfo_ptr = std::shared_ptr<const AccountLoginInfo>;
+
 class IOLoginData {
 	public:
-		static std::pair<uint32_t, std::string> gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime);
+		static AccountLoginInfo_ptr getAccountLoginInfo(Database& db, const std::string& accountName);
+		static void clearAccountLoginCache(uint32_t accountId = 0);
+		static std::pair<uint32_t, std::string> gameworldAuthentication(Database& db, const std::string& accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime);
 		static uint32_t getAccountIdByPlayerName(const std::string& playerName);
 		static uint32_t getAccountIdByPlayerId(uint32_t playerId);
 
 		static AccountType_t getAccountType(uint32_t accountId);
 		static void setAccountType(uint32_t accountId, AccountType_t accountType);
 		static void updateOnlineStatus(uint32_t guid, bool login);
-		static bool preloadPlayer(Player* player, const std::string& name);
+		static bool preloadPlayer(Player* player, const PlayerData& data);
+
+		// the rows preloadPlayer needs, the rest is fetched once the login is admitted
+		static bool fetchPlayerPreloadData(Database& db, PlayerData& data, const std::string& name);
+		static bool fetchPlayerDataById(Database& db, PlayerData& data, uint32_t id);
+		static bool fetchPlayerDataByName(Database& db, PlayerData& data, const std::string& name);
 
 		static bool loadPlayerById(Player* player, uint32_t id);
 		static bool loadPlayerByName(Player* player, const std::string& name);
-		static bool loadPlayer(Player* player, DBResult_ptr result);
+		static bool loadPlayer(Player* player, const PlayerData& data);
+		static void loadDepotItems(Player* player, DBResult_ptr result);
+		static void loadInboxItems(Player* player, DBResult_ptr result);
 		static bool savePlayer(Player* player);
+		static std::shared_ptr<const PlayerSaveData> savePlayerAsync(Player* player);
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 		static std::string getNameByGuid(uint32_t guid);
@@ -43,12 +105,30 @@ class IOLoginData {
 		static void removeVIPEntry(uint32_t accountId, uint32_t guid);
 
 		static void updatePremiumTime(uint32_t accountId, time_t endTime);
+		static bool setAccountPassword(uint32_t accountId, std::string_view password);
 
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
+		// the key of a row in its table, the hash it is compared by and its values, left empty while the row is unchanged
+		struct TableRow {
+			TableRow() = default;
+			TableRow(std::string key, std::string values) : key(std::move(key)), hash(std::hash<std::string>{}(values)), values(std::move(values)) {}
+
+			std::string key;
+			size_t hash = 0;
+			std::string values;
+		};
+		using TableRows = std::vector<TableRow>;
+
+		static bool fetchPlayerData(Database& db, PlayerData& data);
 
-		static void loadItems(ItemMap& itemMap, DBResult_ptr result);
-		static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream);
+		static void loadItems(ItemMap& itemMap, DBResult_ptr result, std::unordered_map<std::string, size_t>& savedRows, std::unordered_map<const Item*, uint32_t>& itemSids);
+		static void serializeItems(Player* player, std::string_view table, const ItemBlockList& itemList, TableRows& rows, PropWriteStream& propWriteStream);
+		static const std::unordered_map<std::string, size_t>* getSavedRows(const Player* player, std::string_view table);
+		static void serializeRows(const Player* player, std::string_view table, std::string_view columns, std::string_view keyColumn, const TableRows& rows, PlayerSaveData& data);
+		static void serializePlayer(Player* player, PlayerSaveData& data);
+		static bool writePlayer(Database& db, PlayerSaveData& data);
+		static void onPlayerSaved(Player* player, const PlayerSaveData& data);
 };
 
 #endif // FS_IOLOGINDATA_H
\ No newline at end of file
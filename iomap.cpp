@@ -5,7 +5,11 @@
 
 #include "iomap.h"
 
+#include "game.h"
 #include "housetile.h"
+#include "tools.h"
+
+extern Game g_game;
 
 /*
 	OTBM_ROOTV1
@@ -31,29 +35,534 @@
 	|--- OTBM_ITEM_DEF (not implemented)
 */
 
-Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z) {
-	if (!ground) {
-		return new StaticTile(x, y, z);
+namespace {
+
+	constexpr OTB::Identifier WORLD_CACHE_IDENTIFIER = {{'O', 'T', 'W', 'C'}};
+	constexpr uint32_t WORLD_CACHE_VERSION = 1;
+
+	// the world cache is only used while the map, spawn and house files are byte for byte the ones it was written from
+	std::optional<uint64_t> getWorldCacheKey(std::string_view contents, const std::filesystem::path& spawnFile, const std::filesystem::path& houseFile, bool paging) {
+		std::optional<std::string> spawns = readFileContents(spawnFile);
+		std::optional<std::string> houses = readFileContents(houseFile);
+		if (!spawns || !houses) {
+			return std::nullopt;
+		}
+
+		uint64_t key = hashContents(contents);
+		for (uint64_t hash : {hashContents(*spawns), hashContents(*houses), static_cast<uint64_t>(paging)}) {
+			key = (key ^ hash) * 0x100000001b3ULL;
+		}
+		return key;
 	}
 
-	Tile* tile;
-	if ((item && item->isBlocking()) || ground->isBlocking()) {
-		tile = new StaticTile(x, y, z);
-	} else {
-		tile = new DynamicTile(x, y, z);
+	// a node of the world cache: [type][props size][props][children size][children], the props are stored unescaped
+	struct FlatNode {
+		std::string_view props;
+		std::string_view children;
+		// what follows the node among the children of its parent
+		std::string_view next;
+		const char* parentChildren = nullptr;
+		uint8_t type = 0;
+	};
+
+	// reads the cached nodes the way OTB::Loader reads the file, a tile area decodes the same from both
+	struct FlatLoader {
+		static bool readNode(std::string_view data, FlatNode& node) {
+			PropStream stream;
+			stream.init(data.data(), data.size());
+
+			uint32_t propsSize, childrenSize;
+			if (!stream.read(node.type) || !stream.read(propsSize) || stream.size() < propsSize) {
+				return false;
+			}
+
+			node.props = stream.view().substr(0, propsSize);
+			stream.skip(propsSize);
+			if (!stream.read(childrenSize) || stream.size() < childrenSize) {
+				return false;
+			}
+
+			node.children = stream.view().substr(0, childrenSize);
+			stream.skip(childrenSize);
+			node.next = stream.view();
+			return true;
+		}
+
+		bool getProps(const FlatNode& node, PropStream& props) const {
+			props.init(node.props.data(), node.props.size());
+			return !node.props.empty();
+		}
+
+		bool nextChild(const FlatNode& parent, FlatNode& child) const {
+			std::string_view data = child.parentChildren == parent.children.data() ? child.next : parent.children;
+			if (data.empty()) {
+				return false;
+			}
+
+			if (!readNode(data, child)) {
+				throw OTB::InvalidOTBFormat{};
+			}
+			child.parentChildren = parent.children.data();
+			return true;
+		}
+
+		void rewind(const FlatNode&) const {}
+	};
+
+	template <typename T>
+	void appendValue(std::string& out, T value) {
+		out.append(reinterpret_cast<const char*>(&value), sizeof(T));
 	}
 
-	tile->internalAddThing(ground);
-	ground->startDecaying();
-	ground = nullptr;
-	return tile;
-}
+	void flattenNode(OTB::Loader& loader, const OTB::Node& node, std::string& out) {
+		PropStream props;
+		std::string_view view = loader.getProps(node, props) ? props.view() : std::string_view{};
+		appendValue(out, node.type);
+		appendValue<uint32_t>(out, view.size());
+		out.append(view);
+
+		std::string children;
+		OTB::Node child;
+		while (loader.nextChild(node, child)) {
+			flattenNode(loader, child, children);
+		}
+		appendValue<uint32_t>(out, children.size());
+		out.append(children);
+	}
+
+	void writePosition(PropWriteStream& stream, const Position& pos) {
+		stream.write(pos.x);
+		stream.write(pos.y);
+		stream.write(pos.z);
+	}
+
+	bool readPosition(PropStream& stream, Position& pos) {
+		return stream.read(pos.x) && stream.read(pos.y) && stream.read(pos.z);
+	}
+
+	bool readString(PropStream& stream, std::string& str) {
+		auto [value, ok] = stream.readString();
+		str = value;
+		return ok;
+	}
+
+	void writeSpawns(PropWriteStream& stream, const std::vector<SpawnRecord>& spawns) {
+		stream.write<uint32_t>(spawns.size());
+		for (const SpawnRecord& spawn : spawns) {
+			writePosition(stream, spawn.centerPos);
+			stream.write(spawn.radius);
+			stream.write<uint8_t>(spawn.empty);
+			stream.write<uint32_t>(spawn.entries.size());
+			for (const SpawnEntryRecord& entry : spawn.entries) {
+				stream.write(entry.type);
+				stream.writeString(entry.name);
+				stream.write(entry.childCount);
+				stream.write(entry.interval);
+				stream.write(entry.direction);
+				stream.write(entry.x);
+				stream.write(entry.y);
+				stream.write<uint32_t>(entry.monsters.size());
+				for (const auto& [name, chance] : entry.monsters) {
+					stream.writeString(name);
+					stream.write(chance);
+				}
+			}
+		}
+	}
+
+	bool readSpawns(PropStream& stream, std::vector<SpawnRecord>& spawns) {
+		uint32_t spawnCount;
+		if (!stream.read(spawnCount)) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < spawnCount; ++i) {
+			SpawnRecord& spawn = spawns.emplace_back();
+			uint8_t empty;
+			uint32_t entryCount;
+			if (!readPosition(stream, spawn.centerPos) || !stream.read(spawn.radius) || !stream.read(empty) || !stream.read(entryCount)) {
+				return false;
+			}
+
+			spawn.empty = empty != 0;
+			for (uint32_t j = 0; j < entryCount; ++j) {
+				SpawnEntryRecord& entry = spawn.entries.emplace_back();
+				uint32_t monsterCount;
+				if (!stream.read(entry.type) || !readString(stream, entry.name) || !stream.read(entry.childCount) || !stream.read(entry.interval) || !stream.read(entry.direction) || !stream.read(entry.x) || !stream.read(entry.y) || !stream.read(monsterCount)) {
+					return false;
+				}
+
+				for (uint32_t k = 0; k < monsterCount; ++k) {
+					auto& [name, chance] = entry.monsters.emplace_back();
+					if (!readString(stream, name) || !stream.read(chance)) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void writeHouses(PropWriteStream& stream, const std::vector<HouseRecord>& houses) {
+		stream.write<uint32_t>(houses.size());
+		for (const HouseRecord& house : houses) {
+			stream.write<uint8_t>(house.hasId);
+			stream.write(house.id);
+			stream.writeString(house.name);
+			writePosition(stream, house.entryPos);
+			stream.write(house.rent);
+			stream.write(house.townId);
+		}
+	}
+
+	bool readHouses(PropStream& stream, std::vector<HouseRecord>& houses) {
+		uint32_t houseCount;
+		if (!stream.read(houseCount)) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < houseCount; ++i) {
+			HouseRecord& house = houses.emplace_back();
+			uint8_t hasId;
+			if (!stream.read(hasId) || !stream.read(house.id) || !readString(stream, house.name) || !readPosition(stream, house.entryPos) || !stream.read(house.rent) || !stream.read(house.townId)) {
+				return false;
+			}
+			house.hasId = hasId != 0;
+		}
+		return true;
+	}
+
+	Tile* createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z, std::vector<Item*>& decayingItems) {
+		if (!ground) {
+			return new StaticTile(x, y, z);
+		}
+
+		Tile* tile;
+		if ((item && item->isBlocking()) || ground->isBlocking()) {
+			tile = new StaticTile(x, y, z);
+		} else {
+			tile = new DynamicTile(x, y, z);
+		}
+
+		tile->internalAddThing(ground);
+		decayingItems.push_back(ground);
+		ground->setLoadedFromMap(true);
+		ground = nullptr;
+		return tile;
+	}
+
+	void addTileItem(StagedTile& staged, Item*& ground, Item* item, StagedTileArea& area) {
+		if (item->getItemCount() == 0) {
+			item->setItemCount(1);
+		}
+
+		if (staged.isHouseTile) {
+			staged.items.push_back(item);
+			return;
+		}
+
+		if (staged.tile) {
+			staged.tile->internalAddThing(item);
+			staged.decayingItems.push_back(item);
+			item->setLoadedFromMap(true);
+		} else if (item->isGroundTile()) {
+			if (ground) {
+				area.discardedItems.push_back(ground);
+			}
+			ground = item;
+		} else {
+			staged.tile = createTile(ground, item, staged.x, staged.y, staged.z, staged.decayingItems);
+			staged.tile->internalAddThing(item);
+			staged.decayingItems.push_back(item);
+			item->setLoadedFromMap(true);
+		}
+	}
+
+	bool unserializeMapItem(OTB::Loader& loader, Item* item, const OTB::Node& itemNode, PropStream& propStream) {
+		return item->unserializeItemNode(loader, itemNode, propStream);
+	}
+
+	// the same as Container::unserializeItemNode, for the nodes of the world cache
+	bool unserializeMapItem(FlatLoader& loader, Item* item, const FlatNode& itemNode, PropStream& propStream) {
+		if (!item->unserializeAttr(propStream)) {
+			return false;
+		}
+
+		Container* container = item->getContainer();
+		if (!container) {
+			return true;
+		}
+
+		FlatNode childNode;
+		while (loader.nextChild(itemNode, childNode)) {
+			PropStream childStream;
+			if (childNode.type != OTBM_ITEM || !loader.getProps(childNode, childStream)) {
+				return false;
+			}
+
+			Item* childItem = Item::CreateItem(childStream);
+			if (!childItem) {
+				return false;
+			}
+
+			if (!unserializeMapItem(loader, childItem, childNode, childStream)) {
+				delete childItem;
+				return false;
+			}
+			container->addItemBack(childItem);
+		}
+		return true;
+	}
+
+	template <typename Loader, typename Node>
+	bool decodeTileArea(Loader& loader, const Node& tileAreaNode, StagedTileArea& area) {
+		PropStream propStream;
+		if (!loader.getProps(tileAreaNode, propStream)) {
+			area.error = "Invalid map node.";
+			return false;
+		}
+
+		OTBM_Destination_coords area_coord;
+		if (!propStream.read(area_coord)) {
+			area.error = "Invalid map node.";
+			return false;
+		}
+
+		uint16_t base_x = area_coord.x;
+		uint16_t base_y = area_coord.y;
+		uint16_t z = area_coord.z;
+
+		Node tileNode;
+		while (loader.nextChild(tileAreaNode, tileNode)) {
+			if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE) {
+				area.error = "Unknown tile node.";
+				return false;
+			}
+
+			if (!loader.getProps(tileNode, propStream)) {
+				area.error = "Could not read node data.";
+				return false;
+			}
+
+			OTBM_Tile_coords tile_coord;
+			if (!propStream.read(tile_coord)) {
+				area.error = "Could not read tile position.";
+				return false;
+			}
+
+			StagedTile& staged = area.tiles.emplace_back();
+			staged.x = base_x + tile_coord.x;
+			staged.y = base_y + tile_coord.y;
+			staged.z = z;
+
+			uint16_t x = staged.x;
+			uint16_t y = staged.y;
+			Item* ground_item = nullptr;
+
+			if (tileNode.type == OTBM_HOUSETILE) {
+				staged.isHouseTile = true;
+				if (!propStream.read<uint32_t>(staged.houseId)) {
+					area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z);
+					return false;
+				}
+			}
+
+			uint8_t attribute;
+			//read tile attributes
+			while (propStream.read<uint8_t>(attribute)) {
+				switch (attribute) {
+					case OTBM_ATTR_TILE_FLAGS: {
+						uint32_t flags;
+						if (!propStream.read<uint32_t>(flags)) {
+							area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z);
+							return false;
+						}
+
+						if ((flags & OTBM_TILEFLAG_PROTECTIONZONE) != 0) {
+							staged.flags |= TILESTATE_PROTECTIONZONE;
+						} else if ((flags & OTBM_TILEFLAG_NOPVPZONE) != 0) {
+							staged.flags |= TILESTATE_NOPVPZONE;
+						} else if ((flags & OTBM_TILEFLAG_PVPZONE) != 0) {
+							staged.flags |= TILESTATE_PVPZONE;
+						}
+
+						if ((flags & OTBM_TILEFLAG_NOLOGOUT) != 0) {
+							staged.flags |= TILESTATE_NOLOGOUT;
+						}
+						break;
+					}
+
+					case OTBM_ATTR_ITEM: {
+						Item* item = Item::CreateItem(propStream);
+						if (!item) {
+							area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z);
+							return false;
+						}
+
+						addTileItem(staged, ground_item, item, area);
+						break;
+					}
+
+					default:
+						area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z);
+						return false;
+				}
+			}
+
+			Node itemNode;
+			while (loader.nextChild(tileNode, itemNode)) {
+				if (itemNode.type != OTBM_ITEM) {
+					area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z);
+					return false;
+				}
+
+				PropStream stream;
+				if (!loader.getProps(itemNode, stream)) {
+					area.error = "Invalid item node.";
+					return false;
+				}
+
+				Item* item = Item::CreateItem(stream);
+				if (!item) {
+					area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z);
+					return false;
+				}
+
+				if (!unserializeMapItem(loader, item, itemNode, stream)) {
+					area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID());
+					area.discardedItems.push_back(item);
+					return false;
+				}
+
+				addTileItem(staged, ground_item, item, area);
+			}
+
+			if (!staged.tile && !staged.isHouseTile) {
+				staged.tile = createTile(ground_item, nullptr, x, y, z, staged.decayingItems);
+			}
+		}
+		return true;
+	}
+
+	// a tile area can be left in the file when it lines up with a paging region and no house keeps pointers to its tiles
+	bool isPageable(OTB::Loader& loader, const OTB::Node& tileAreaNode, PagedTileArea& pagedArea) {
+		PropStream propStream;
+		OTBM_Destination_coords area_coord;
+		if (!loader.getProps(tileAreaNode, propStream) || !propStream.read(area_coord)) {
+			return false;
+		}
+
+		pagedArea.node = tileAreaNode;
+		pagedArea.x = area_coord.x;
+		pagedArea.y = area_coord.y;
+		pagedArea.z = area_coord.z;
+		if (pagedArea.x % MapPager::REGION_SIZE != 0 || pagedArea.y % MapPager::REGION_SIZE != 0 || pagedArea.z >= MAP_MAX_LAYERS) {
+			return false;
+		}
+
+		OTB::Node tileNode;
+		while (loader.nextChild(tileAreaNode, tileNode)) {
+			if (tileNode.type == OTBM_HOUSETILE) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// every thread reads with its own cursor over the shared mapping and packs what it creates into its own slabs
+	template <typename Loader, typename Work>
+	void forEachTileArea(const Loader& loader, size_t count, Work&& work) {
+		std::atomic<size_t> next = 0;
+		auto run = [&]() {
+			Loader areaLoader = loader;
+			SlabAllocator<Item>::Arena itemArena;
+			SlabAllocator<Tile>::Arena tileArena;
+			for (size_t i = next++; i < count; i = next++) {
+				work(areaLoader, i);
+			}
+		};
+
+		const size_t threadCount = std::min<size_t>(std::max<unsigned>(1, std::thread::hardware_concurrency()), count);
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < threadCount; ++i) {
+			threads.emplace_back(run);
+		}
+		run();
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	template <typename Loader, typename Node>
+	void decodeTileAreas(const Loader& loader, const std::vector<Node>& tileAreaNodes, std::vector<StagedTileArea>& areas) {
+		areas.resize(tileAreaNodes.size());
+		forEachTileArea(loader, areas.size(), [&](Loader& areaLoader, size_t i) {
+			StagedTileArea& area = areas[i];
+			Item::deferredGameCalls = &area.gameCalls;
+			try {
+				areaLoader.rewind(tileAreaNodes[i]);
+				decodeTileArea(areaLoader, tileAreaNodes[i], area);
+			} catch (const OTB::InvalidOTBFormat& err) {
+				area.error = err.what();
+			}
+			Item::deferredGameCalls = nullptr;
+		});
+	}
+
+	void commitTileArea(Map* map, StagedTileArea& area) {
+		for (auto& gameCall : area.gameCalls) {
+			gameCall();
+		}
+
+		for (Item* item : area.discardedItems) {
+			delete item;
+		}
+
+		for (StagedTile& staged : area.tiles) {
+			Tile* tile = staged.tile;
+			if (staged.isHouseTile) {
+				House* house = map->houses.addHouse(staged.houseId);
+				tile = new HouseTile(staged.x, staged.y, staged.z, house);
+				house->addTile(static_cast<HouseTile*>(tile));
+
+				for (Item* item : staged.items) {
+					if (item->isMoveable()) {
+						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", in house: " << house->getId() << ", at position [x: " << staged.x << ", y: " << staged.y << ", z: " << staged.z << "]." << std::endl;
+						delete item;
+						continue;
+					}
+
+					tile->internalAddThing(item);
+					item->startDecaying();
+					item->setLoadedFromMap(true);
+				}
+			}
+
+			for (Item* item : staged.decayingItems) {
+				item->startDecaying();
+			}
+
+			tile->setFlag(static_cast<tileflags_t>(staged.flags));
+			map->setTile(staged.x, staged.y, staged.z, tile);
+		}
+	}
+
+} // namespace
 
 bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName) {
+	if (!decodeMap(fileName)) {
+		return false;
+	}
+
+	commitMap(map);
+	return true;
+}
+
+bool IOMap::decodeMap(const std::filesystem::path& fileName, bool paging, bool world) {
 	int64_t start = OTSYS_TIME();
 	try {
 		OTB::Loader loader{fileName.string(), OTB::Identifier{{'O', 'T', 'B', 'M'}}};
-		auto& root = loader.parseTree();
+		OTB::Node root = loader.getRoot();
 
 		PropStream propStream;
 		if (!loader.getProps(root, propStream)) {
@@ -101,47 +610,151 @@ bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName) {
 		}
 
 		std::cout << "> Map size: " << root_header.width << "x" << root_header.height << '.' << std::endl;
-		map->width = root_header.width;
-		map->height = root_header.height;
+		width = root_header.width;
+		height = root_header.height;
 
-		if (root.children.size() != 1 || root.children[0].type != OTBM_MAP_DATA) {
+		OTB::Node mapNode;
+		if (!loader.nextChild(root, mapNode) || mapNode.type != OTBM_MAP_DATA) {
 			setLastErrorString("Could not read data node.");
 			return false;
 		}
 
-		auto& mapNode = root.children[0];
-		if (!parseMapDataAttributes(loader, mapNode, *map, fileName)) {
+		if (!parseMapDataAttributes(loader, mapNode, fileName)) {
 			return false;
 		}
 
-		for (auto& mapDataNode : mapNode.children) {
-			if (mapDataNode.type == OTBM_TILE_AREA) {
-				if (!parseTileArea(loader, mapDataNode, *map)) {
-					return false;
-				}
-			} else if (mapDataNode.type == OTBM_TOWNS) {
-				if (!parseTowns(loader, mapDataNode, *map)) {
-					return false;
-				}
-			} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
-				if (!parseWaypoints(loader, mapDataNode, *map)) {
+		// the world cache holds the decoded nodes of the tile areas, the towns, waypoints, spawns and houses
+		// the map file is still opened, it is hashed for the key and the paged tile areas are read from it
+		std::optional<uint64_t> cacheKey;
+		if (world) {
+			if (spawnFile.empty()) {
+				spawnFile = getString(ConfigManager::MAP_NAME) + "-spawn.xml";
+			}
+
+			if (houseFile.empty()) {
+				houseFile = getString(ConfigManager::MAP_NAME) + "-house.xml";
+			}
+
+			if (getBoolean(ConfigManager::USE_WORLD_CACHE)) {
+				cacheKey = getWorldCacheKey(loader.getContents(), spawnFile, houseFile, paging);
+			}
+		}
+
+		std::filesystem::path cacheFile = fileName;
+		cacheFile += ".cache";
+
+		std::string cache;
+		std::vector<std::string_view> flatAreas;
+		if (cacheKey && readWorldCache(cacheFile, *cacheKey, loader, cache, flatAreas)) {
+			std::cout << "> Using world cache " << cacheFile << '.' << std::endl;
+			if (!parseFlatTileAreas(flatAreas)) {
+				return false;
+			}
+		} else {
+			// tile areas are only located here and decoded in parallel afterwards
+			std::vector<OTB::Node> tileAreaNodes;
+
+			OTB::Node mapDataNode;
+			while (loader.nextChild(mapNode, mapDataNode)) {
+				if (mapDataNode.type == OTBM_TILE_AREA) {
+					tileAreaNodes.push_back(mapDataNode);
+				} else if (mapDataNode.type == OTBM_TOWNS) {
+					if (!parseTowns(loader, mapDataNode)) {
+						return false;
+					}
+				} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
+					if (!parseWaypoints(loader, mapDataNode)) {
+						return false;
+					}
+				} else {
+					setLastErrorString("Unknown map node.");
 					return false;
 				}
-			} else {
-				setLastErrorString("Unknown map node.");
+			}
+
+			OTB::Node extraNode;
+			if (loader.nextChild(root, extraNode)) {
+				setLastErrorString("Could not read data node.");
+				return false;
+			}
+
+			if (!parseTileAreas(loader, tileAreaNodes, paging)) {
 				return false;
 			}
+
+			if (cacheKey) {
+				spawnRecords = Spawns::parseSpawns(spawnFile.string());
+				houseRecords = Houses::parseHousesXML(houseFile.string());
+				if (spawnRecords && houseRecords) {
+					writeWorldCache(cacheFile, *cacheKey, loader, tileAreaNodes);
+				}
+			}
+		}
+
+		// the paged tile areas are read from this mapping whenever they are needed
+		if (!pagedAreas.empty()) {
+			pagingLoader.emplace(loader);
 		}
 	} catch (const OTB::InvalidOTBFormat& err) {
 		setLastErrorString(err.what());
 		return false;
 	}
 
-	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
+	std::cout << "> Map decoding time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	return true;
 }
 
-bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, const std::filesystem::path& fileName) {
+void IOMap::commitMap(Map* map) {
+	map->width = width;
+	map->height = height;
+
+	if (!spawnFile.empty()) {
+		map->spawnfile = spawnFile;
+	}
+
+	if (!houseFile.empty()) {
+		map->housefile = houseFile;
+	}
+
+	for (const StagedTown& stagedTown : towns) {
+		Town* town = map->towns.getTown(stagedTown.id);
+		if (!town) {
+			town = new Town(stagedTown.id);
+			map->towns.addTown(stagedTown.id, town);
+		}
+
+		town->setName(stagedTown.name);
+		town->setTemplePos(stagedTown.templePos);
+	}
+
+	for (const auto& [name, pos] : waypoints) {
+		map->waypoints[name] = pos;
+	}
+
+	// merging in file order gives the same map, houses and registrations as a sequential load
+	for (StagedTileArea& area : areas) {
+		// tiles loaded on top of a paged region must not be dropped with it
+		if (map->pager) {
+			for (const StagedTile& staged : area.tiles) {
+				map->pager->pinRegion(staged.x, staged.y, staged.z);
+			}
+		}
+
+		commitTileArea(map, area);
+	}
+	areas.clear();
+
+	if (pagingLoader) {
+		map->pager = std::make_unique<MapPager>(*map, std::move(*pagingLoader));
+		for (const PagedTileArea& pagedArea : pagedAreas) {
+			map->pager->addTileArea(pagedArea);
+		}
+		pagingLoader.reset();
+		pagedAreas.clear();
+	}
+}
+
+bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, const std::filesystem::path& fileName) {
 	PropStream propStream;
 	if (!loader.getProps(mapNode, propStream)) {
 		setLastErrorString("Could not read map data attributes.");
@@ -167,7 +780,7 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 					return false;
 				}
 
-				map.spawnfile = fileName.parent_path() / spawnFile;
+				this->spawnFile = fileName.parent_path() / spawnFile;
 				break;
 			}
 
@@ -178,7 +791,7 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 					return false;
 				}
 
-				map.housefile = fileName.parent_path() / houseFile;
+				this->houseFile = fileName.parent_path() / houseFile;
 				break;
 			}
 
@@ -190,191 +803,264 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 	return true;
 }
 
-bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map) {
-	PropStream propStream;
-	if (!loader.getProps(tileAreaNode, propStream)) {
-		setLastErrorString("Invalid map node.");
-		return false;
-	}
+bool IOMap::parseTileAreas(OTB::Loader& loader, std::vector<OTB::Node>& tileAreaNodes, bool paging) {
+	if (paging) {
+		std::vector<PagedTileArea> candidates(tileAreaNodes.size());
+		std::vector<uint8_t> pageable(tileAreaNodes.size());
+		forEachTileArea(loader, tileAreaNodes.size(), [&](OTB::Loader& areaLoader, size_t i) {
+			try {
+				areaLoader.rewind(tileAreaNodes[i]);
+				pageable[i] = isPageable(areaLoader, tileAreaNodes[i], candidates[i]);
+			} catch (const OTB::InvalidOTBFormat&) {
+				// decoding the area reports the error
+				pageable[i] = false;
+			}
+		});
+
+		// a region is only paged if all of its tile areas can be, the tiles of an unaligned area may spill into four regions
+		std::unordered_set<size_t> loadedRegions;
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			const PagedTileArea& area = candidates[i];
+			// no node means the area header could not be read, decoding it fails anyway
+			if (pageable[i] || !area.node.propsBegin) {
+				continue;
+			}
 
-	OTBM_Destination_coords area_coord;
-	if (!propStream.read(area_coord)) {
-		setLastErrorString("Invalid map node.");
-		return false;
+			const uint16_t endX = std::min<uint32_t>(area.x + MapPager::REGION_SIZE - 1, std::numeric_limits<uint16_t>::max());
+			const uint16_t endY = std::min<uint32_t>(area.y + MapPager::REGION_SIZE - 1, std::numeric_limits<uint16_t>::max());
+			for (uint16_t x : {area.x, endX}) {
+				for (uint16_t y : {area.y, endY}) {
+					loadedRegions.insert(MapPager::getRegionKey(x, y, area.z));
+				}
+			}
+		}
+
+		std::vector<OTB::Node> loadedNodes;
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			const PagedTileArea& area = candidates[i];
+			if (pageable[i] && !loadedRegions.contains(MapPager::getRegionKey(area.x, area.y, area.z))) {
+				pagedAreas.push_back(area);
+			} else {
+				loadedNodes.push_back(tileAreaNodes[i]);
+			}
+		}
+
+		std::cout << "> Map paging: " << pagedAreas.size() << " of " << tileAreaNodes.size() << " tile areas are loaded on demand." << std::endl;
+		tileAreaNodes = std::move(loadedNodes);
 	}
 
-	uint16_t base_x = area_coord.x;
-	uint16_t base_y = area_coord.y;
-	uint16_t z = area_coord.z;
+	decodeTileAreas(loader, tileAreaNodes, areas);
+	return checkTileAreas();
+}
 
-	for (auto& tileNode : tileAreaNode.children) {
-		if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE) {
-			setLastErrorString("Unknown tile node.");
+bool IOMap::parseFlatTileAreas(const std::vector<std::string_view>& flatAreas) {
+	std::vector<FlatNode> tileAreaNodes(flatAreas.size());
+	for (size_t i = 0; i < flatAreas.size(); ++i) {
+		if (!FlatLoader::readNode(flatAreas[i], tileAreaNodes[i])) {
+			setLastErrorString("Invalid map node.");
 			return false;
 		}
+	}
 
-		if (!loader.getProps(tileNode, propStream)) {
-			setLastErrorString("Could not read node data.");
+	decodeTileAreas(FlatLoader{}, tileAreaNodes, areas);
+	return checkTileAreas();
+}
+
+bool IOMap::checkTileAreas() {
+	for (const StagedTileArea& area : areas) {
+		if (!area.error.empty()) {
+			setLastErrorString(area.error);
 			return false;
 		}
+	}
+	return true;
+}
 
-		OTBM_Tile_coords tile_coord;
-		if (!propStream.read(tile_coord)) {
-			setLastErrorString("Could not read tile position.");
+bool IOMap::readWorldCache(const std::filesystem::path& cacheFile, uint64_t key, const OTB::Loader& loader, std::string& cache, std::vector<std::string_view>& flatAreas) {
+	std::optional<std::string> contents = readFileContents(cacheFile);
+	if (!contents) {
+		return false;
+	}
+
+	PropStream stream;
+	stream.init(contents->data(), contents->size());
+
+	OTB::Identifier identifier;
+	uint32_t version;
+	uint64_t cachedKey, hash;
+	if (!stream.read(identifier) || identifier != WORLD_CACHE_IDENTIFIER || !stream.read(version) || version != WORLD_CACHE_VERSION) {
+		return false;
+	}
+
+	// a cache that was damaged after it was written is parsed again rather than replayed
+	if (!stream.read(cachedKey) || cachedKey != key || !stream.read(hash) || hash != hashContents(stream.view())) {
+		return false;
+	}
+
+	// read aside, nothing is kept if the cache can not be read to the end
+	uint32_t cachedWidth, cachedHeight, count;
+	std::string cachedSpawnFile, cachedHouseFile;
+	if (!stream.read(cachedWidth) || !stream.read(cachedHeight) || !readString(stream, cachedSpawnFile) || !readString(stream, cachedHouseFile)) {
+		return false;
+	}
+
+	std::vector<StagedTown> cachedTowns;
+	if (!stream.read(count)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		StagedTown& town = cachedTowns.emplace_back();
+		if (!stream.read(town.id) || !readString(stream, town.name) || !readPosition(stream, town.templePos)) {
 			return false;
 		}
+	}
 
-		uint16_t x = base_x + tile_coord.x;
-		uint16_t y = base_y + tile_coord.y;
+	std::vector<std::pair<std::string, Position>> cachedWaypoints;
+	if (!stream.read(count)) {
+		return false;
+	}
 
-		bool isHouseTile = false;
-		House* house = nullptr;
-		Tile* tile = nullptr;
-		Item* ground_item = nullptr;
-		uint32_t tileflags = TILESTATE_NONE;
+	for (uint32_t i = 0; i < count; ++i) {
+		auto& [name, pos] = cachedWaypoints.emplace_back();
+		if (!readString(stream, name) || !readPosition(stream, pos)) {
+			return false;
+		}
+	}
 
-		if (tileNode.type == OTBM_HOUSETILE) {
-			uint32_t houseId;
-			if (!propStream.read<uint32_t>(houseId)) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z));
-				return false;
-			}
+	// the paged tile areas stay in the map file, every one must still start where it was found
+	const std::string_view mapContents = loader.getContents();
+	std::vector<PagedTileArea> cachedPagedAreas;
+	if (!stream.read(count)) {
+		return false;
+	}
 
-			house = map.houses.addHouse(houseId);
-			if (!house) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
-				return false;
-			}
+	for (uint32_t i = 0; i < count; ++i) {
+		uint64_t offset, depth;
+		uint8_t type;
+		PagedTileArea& pagedArea = cachedPagedAreas.emplace_back();
+		if (!stream.read(offset) || !stream.read(depth) || !stream.read(type) || !stream.read(pagedArea.x) || !stream.read(pagedArea.y) || !stream.read(pagedArea.z)) {
+			return false;
+		}
 
-			tile = new HouseTile(x, y, z, house);
-			house->addTile(static_cast<HouseTile*>(tile));
-			isHouseTile = true;
+		// the props of a node follow its start marker and type
+		if (offset < 2 || offset >= mapContents.size() || static_cast<uint8_t>(mapContents[offset - 2]) != OTB::Node::START || static_cast<uint8_t>(mapContents[offset - 1]) != type) {
+			return false;
 		}
 
-		uint8_t attribute;
-		//read tile attributes
-		while (propStream.read<uint8_t>(attribute)) {
-			switch (attribute) {
-				case OTBM_ATTR_TILE_FLAGS: {
-					uint32_t flags;
-					if (!propStream.read<uint32_t>(flags)) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z));
-						return false;
-					}
+		pagedArea.node.propsBegin = mapContents.data() + offset;
+		pagedArea.node.depth = depth;
+		pagedArea.node.type = type;
+	}
 
-					if ((flags & OTBM_TILEFLAG_PROTECTIONZONE) != 0) {
-						tileflags |= TILESTATE_PROTECTIONZONE;
-					} else if ((flags & OTBM_TILEFLAG_NOPVPZONE) != 0) {
-						tileflags |= TILESTATE_NOPVPZONE;
-					} else if ((flags & OTBM_TILEFLAG_PVPZONE) != 0) {
-						tileflags |= TILESTATE_PVPZONE;
-					}
+	std::vector<std::string_view> cachedFlatAreas;
+	if (!stream.read(count)) {
+		return false;
+	}
 
-					if ((flags & OTBM_TILEFLAG_NOLOGOUT) != 0) {
-						tileflags |= TILESTATE_NOLOGOUT;
-					}
-					break;
-				}
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t size;
+		if (!stream.read(size) || stream.size() < size) {
+			return false;
+		}
 
-				case OTBM_ATTR_ITEM: {
-					Item* item = Item::CreateItem(propStream);
-					if (!item) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
-						return false;
-					}
+		cachedFlatAreas.push_back(stream.view().substr(0, size));
+		stream.skip(size);
+	}
 
-					if (isHouseTile && item->isMoveable()) {
-						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
-						delete item;
-					} else {
-						if (item->getItemCount() == 0) {
-							item->setItemCount(1);
-						}
+	std::vector<SpawnRecord> cachedSpawns;
+	std::vector<HouseRecord> cachedHouses;
+	if (!readSpawns(stream, cachedSpawns) || !readHouses(stream, cachedHouses) || stream.size() != 0) {
+		return false;
+	}
 
-						if (tile) {
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						} else if (item->isGroundTile()) {
-							delete ground_item;
-							ground_item = item;
-						} else {
-							tile = createTile(ground_item, item, x, y, z);
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
-					}
-					break;
-				}
+	width = cachedWidth;
+	height = cachedHeight;
+	spawnFile = cachedSpawnFile;
+	houseFile = cachedHouseFile;
+	towns = std::move(cachedTowns);
+	waypoints = std::move(cachedWaypoints);
+	pagedAreas = std::move(cachedPagedAreas);
+	spawnRecords = std::move(cachedSpawns);
+	houseRecords = std::move(cachedHouses);
+
+	// the views point into the cache, a moved string keeps its buffer
+	cache = std::move(*contents);
+	flatAreas = std::move(cachedFlatAreas);
+	return true;
+}
 
-				default:
-					setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z));
-					return false;
-			}
+void IOMap::writeWorldCache(const std::filesystem::path& cacheFile, uint64_t key, const OTB::Loader& loader, const std::vector<OTB::Node>& tileAreaNodes) {
+	std::vector<std::string> flatAreas(tileAreaNodes.size());
+	std::atomic<bool> failed = false;
+	forEachTileArea(loader, flatAreas.size(), [&](OTB::Loader& areaLoader, size_t i) {
+		try {
+			areaLoader.rewind(tileAreaNodes[i]);
+			flattenNode(areaLoader, tileAreaNodes[i], flatAreas[i]);
+		} catch (const OTB::InvalidOTBFormat&) {
+			failed = true;
 		}
+	});
 
-		for (auto& itemNode : tileNode.children) {
-			if (itemNode.type != OTBM_ITEM) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z));
-				return false;
-			}
-
-			PropStream stream;
-			if (!loader.getProps(itemNode, stream)) {
-				setLastErrorString("Invalid item node.");
-				return false;
-			}
+	if (failed) {
+		return;
+	}
 
-			Item* item = Item::CreateItem(stream);
-			if (!item) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
-				return false;
-			}
+	PropWriteStream body;
+	body.write(width);
+	body.write(height);
+	body.writeString(spawnFile.string());
+	body.writeString(houseFile.string());
+
+	body.write<uint32_t>(towns.size());
+	for (const StagedTown& town : towns) {
+		body.write(town.id);
+		body.writeString(town.name);
+		writePosition(body, town.templePos);
+	}
 
-			if (!item->unserializeItemNode(loader, itemNode, stream)) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID()));
-				delete item;
-				return false;
-			}
+	body.write<uint32_t>(waypoints.size());
+	for (const auto& [name, pos] : waypoints) {
+		body.writeString(name);
+		writePosition(body, pos);
+	}
 
-			if (isHouseTile && item->isMoveable()) {
-				std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
-				delete item;
-			} else {
-				if (item->getItemCount() == 0) {
-					item->setItemCount(1);
-				}
+	const std::string_view mapContents = loader.getContents();
+	body.write<uint32_t>(pagedAreas.size());
+	for (const PagedTileArea& pagedArea : pagedAreas) {
+		body.write<uint64_t>(pagedArea.node.propsBegin - mapContents.data());
+		body.write<uint64_t>(pagedArea.node.depth);
+		body.write(pagedArea.node.type);
+		body.write(pagedArea.x);
+		body.write(pagedArea.y);
+		body.write(pagedArea.z);
+	}
 
-				if (tile) {
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				} else if (item->isGroundTile()) {
-					delete ground_item;
-					ground_item = item;
-				} else {
-					tile = createTile(ground_item, item, x, y, z);
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				}
-			}
-		}
+	body.write<uint32_t>(flatAreas.size());
+	for (const std::string& flatArea : flatAreas) {
+		body.write<uint32_t>(flatArea.size());
+		body.writeBytes(flatArea);
+	}
 
-		if (!tile) {
-			tile = createTile(ground_item, nullptr, x, y, z);
-		}
+	writeSpawns(body, *spawnRecords);
+	writeHouses(body, *houseRecords);
 
-		tile->setFlag(static_cast<tileflags_t>(tileflags));
+	PropWriteStream header;
+	header.write(WORLD_CACHE_IDENTIFIER);
+	header.write(WORLD_CACHE_VERSION);
+	header.write(key);
+	header.write(hashContents(body.getStream()));
 
-		map.setTile(x, y, z, tile);
+	std::string contents{header.getStream()};
+	contents.append(body.getStream());
+	if (!replaceFileContents(cacheFile, contents)) {
+		std::cout << "[Warning - IOMap::loadMap] Could not write world cache " << cacheFile << '.' << std::endl;
 	}
-	return true;
 }
 
-bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map) {
-	for (auto& townNode : townsNode.children) {
+bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode) {
+	OTB::Node townNode;
+	while (loader.nextChild(townsNode, townNode)) {
 		PropStream propStream;
 		if (townNode.type != OTBM_TOWN) {
 			setLastErrorString("Unknown town node.");
@@ -392,34 +1078,27 @@ bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map
 			return false;
 		}
 
-		Town* town = map.towns.getTown(townId);
-		if (!town) {
-			town = new Town(townId);
-			map.towns.addTown(townId, town);
-		}
-
 		auto [townName, ok] = propStream.readString();
 		if (!ok) {
 			setLastErrorString("Could not read town name.");
 			return false;
 		}
 
-		town->setName(townName);
-
 		OTBM_Destination_coords town_coords;
 		if (!propStream.read(town_coords)) {
 			setLastErrorString("Could not read town coordinates.");
 			return false;
 		}
 
-		town->setTemplePos(Position(town_coords.x, town_coords.y, town_coords.z));
+		towns.emplace_back(townId, std::string{townName}, Position(town_coords.x, town_coords.y, town_coords.z));
 	}
 	return true;
 }
 
-bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map) {
+bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode) {
 	PropStream propStream;
-	for (auto& node : waypointsNode.children) {
+	OTB::Node node;
+	while (loader.nextChild(waypointsNode, node)) {
 		if (node.type != OTBM_WAYPOINT) {
 			setLastErrorString("Unknown waypoint node.");
 			return false;
@@ -442,7 +1121,228 @@ bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode,
 			return false;
 		}
 
-		map.waypoints[std::string{name}] = Position(waypoint_coords.x, waypoint_coords.y, waypoint_coords.z);
+		waypoints.emplace_back(std::string{name}, Position(waypoint_coords.x, waypoint_coords.y, waypoint_coords.z));
+	}
+	return true;
+}
+
+bool IOMap::loadSpawns(Map* map, bool isCalledByLua) {
+	if (map->spawnfile.empty()) {
+		//OTBM file doesn't tell us about the spawnfile,
+		//lets guess it is mapname-spawn.xml.
+		map->spawnfile = getString(ConfigManager::MAP_NAME);
+		map->spawnfile += "-spawn.xml";
+	}
+
+	if (spawnRecords) {
+		map->spawns.loadSpawns(map->spawnfile.string(), *spawnRecords, isCalledByLua);
+		return true;
+	}
+	return map->spawns.loadFromXml(map->spawnfile.string(), isCalledByLua);
+}
+
+bool IOMap::loadHouses(Map* map) {
+	if (map->housefile.empty()) {
+		//OTBM file doesn't tell us about the housefile,
+		//lets guess it is mapname-house.xml.
+		map->housefile = getString(ConfigManager::MAP_NAME);
+		map->housefile += "-house.xml";
+	}
+
+	if (houseRecords) {
+		return map->houses.loadHouses(*houseRecords);
+	}
+	return map->houses.loadHousesXML(map->housefile.string());
+}
+
+MapPager::MapPager(Map& map, OTB::Loader loader) : map(map), loader(std::move(loader)), regionIndex(static_cast<size_t>(MAP_MAX_LAYERS) << 16) {}
+
+void MapPager::addTileArea(const PagedTileArea& tileArea) {
+	uint32_t& index = regionIndex[getRegionKey(tileArea.x, tileArea.y, tileArea.z)];
+	if (index == 0) {
+		Region& region = regions.emplace_back();
+		region.x = tileArea.x;
+		region.y = tileArea.y;
+		region.z = tileArea.z;
+		index = regions.size();
+	}
+	regions[index - 1].tileAreas.push_back(tileArea.node);
+}
+
+MapPager::Region* MapPager::getRegion(uint16_t x, uint16_t y, uint8_t z) {
+	if (z >= MAP_MAX_LAYERS) {
+		return nullptr;
+	}
+
+	uint32_t index = regionIndex[getRegionKey(x, y, z)];
+	return index != 0 ? &regions[index - 1] : nullptr;
+}
+
+bool MapPager::loadRegion(uint16_t x, uint16_t y, uint8_t z) {
+	Region* region = getRegion(x, y, z);
+	if (!region || region->loaded) {
+		return false;
+	}
+
+	region->loaded = true;
+	region->used = false;
+	region->lastUsed = OTSYS_TIME();
+	++loads;
+
+	// the region is packed into slabs of its own, they go back to the heap once it is dropped again
+	SlabAllocator<Item>::Arena itemArena;
+	SlabAllocator<Tile>::Arena tileArena;
+	loadingRegion = region;
+	for (const OTB::Node& node : region->tileAreas) {
+		StagedTileArea area;
+		Item::deferredGameCalls = &area.gameCalls;
+		try {
+			loader.rewind(node);
+			decodeTileArea(loader, node, area);
+		} catch (const OTB::InvalidOTBFormat& err) {
+			area.error = err.what();
+		}
+		Item::deferredGameCalls = nullptr;
+
+		// the area decoded at startup, so the file changed since, what was read is kept and never dropped
+		if (!area.error.empty()) {
+			std::cout << "[Error - MapPager::loadRegion] " << area.error << std::endl;
+			region->pinned = true;
+		}
+
+		commitTileArea(&map, area);
 	}
+	loadingRegion = nullptr;
 	return true;
+}
+
+void MapPager::pinRegion(uint16_t x, uint16_t y, uint8_t z) {
+	if (Region* region = getRegion(x, y, z)) {
+		loadRegion(x, y, z);
+		region->pinned = true;
+	}
+}
+
+void MapPager::setRegionChanged(uint16_t x, uint16_t y, uint8_t z) {
+	Region* region = getRegion(x, y, z);
+	if (region && region != loadingRegion) {
+		region->changed = true;
+	}
+}
+
+bool MapPager::isRegionInUse(const Region& region, const std::unordered_set<const Tile*>& tilesInUse) {
+	// players keep raw pointers to the containers they opened and the items they trade, even from outside the region
+	for (const Tile* tile : tilesInUse) {
+		const Position& pos = tile->getPosition();
+		if (pos.z == region.z && pos.x >= region.x && pos.x < region.x + REGION_SIZE && pos.y >= region.y && pos.y < region.y + REGION_SIZE) {
+			return true;
+		}
+	}
+
+	for (int32_t x = region.x; x < region.x + REGION_SIZE; x += FLOOR_SIZE) {
+		for (int32_t y = region.y; y < region.y + REGION_SIZE; y += FLOOR_SIZE) {
+			// the creatures of a leaf are those of all its floors
+			QTreeLeafNode* leaf = map.getQTNode(x, y);
+			if (!leaf) {
+				continue;
+			}
+
+			if (!leaf->creature_list.empty()) {
+				return true;
+			}
+
+			if (const Floor* floor = leaf->array[region.z]) {
+				for (const auto& row : floor->tiles) {
+					for (const Tile* tile : row) {
+						if (tile && !g_game.canReleaseTile(tile)) {
+							return true;
+						}
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+void MapPager::unloadRegion(Region& region) {
+	for (int32_t x = region.x; x < region.x + REGION_SIZE; x += FLOOR_SIZE) {
+		for (int32_t y = region.y; y < region.y + REGION_SIZE; y += FLOOR_SIZE) {
+			QTreeLeafNode* leaf = map.getQTNode(x, y);
+			if (!leaf) {
+				continue;
+			}
+
+			Floor*& floor = leaf->array[region.z];
+			if (!floor) {
+				continue;
+			}
+
+			for (auto& row : floor->tiles) {
+				for (Tile* tile : row) {
+					if (tile) {
+						g_game.releaseTile(tile);
+					}
+				}
+			}
+
+			delete floor;
+			floor = nullptr;
+		}
+	}
+
+	region.loaded = false;
+	++unloads;
+}
+
+void MapPager::unloadIdleRegions(int64_t idleTime) {
+	const int64_t now = OTSYS_TIME();
+	// collected once per pass, only when a region is idle long enough to be checked
+	std::optional<std::unordered_set<const Tile*>> tilesInUse;
+	for (Region& region : regions) {
+		if (!region.loaded) {
+			continue;
+		}
+
+		if (region.used) {
+			region.used = false;
+			region.lastUsed = now;
+			continue;
+		}
+
+		if (region.pinned || region.changed || now - region.lastUsed < idleTime) {
+			continue;
+		}
+
+		if (!tilesInUse) {
+			tilesInUse = g_game.getTilesInUse();
+		}
+
+		// checked again once it has been idle for another idleTime
+		if (isRegionInUse(region, *tilesInUse)) {
+			region.lastUsed = now;
+			continue;
+		}
+
+		unloadRegion(region);
+	}
+}
+
+MapPagerStats MapPager::getStats() const {
+	MapPagerStats stats;
+	stats.regions = regions.size();
+	stats.loads = loads;
+	stats.unloads = unloads;
+	for (const Region& region : regions) {
+		if (region.loaded) {
+			++stats.loadedRegions;
+		}
+		if (region.pinned) {
+			++stats.pinnedRegions;
+		}
+		if (region.changed) {
+			++stats.changedRegions;
+		}
+	}
+	return stats;
 }
\ No newline at end of file
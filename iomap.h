@@ -83,41 +83,62 @@ struct OTBM_Tile_coords {
 
 #pragma pack()
 
-class IOMap {
-	static Tile* createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z);
+struct StagedTile {
+	Tile* tile = nullptr;
+	// house tiles are only created when committing, houses are shared between tile areas
+	std::vector<Item*> items;
+	std::vector<Item*> decayingItems;
+	uint32_t houseId = 0;
+	uint32_t flags = TILESTATE_NONE;
+	uint16_t x = 0;
+	uint16_t y = 0;
+	uint8_t z = 0;
+	bool isHouseTile = false;
+};
+
+// one tile area decoded by a loading thread, merged into the map in file order
+struct StagedTileArea {
+	std::vector<StagedTile> tiles;
+	std::vector<std::function<void()>> gameCalls;
+	std::vector<Item*> discardedItems;
+	std::string error;
+};
+
+// a tile area left in the file by mapPaging, decoded once one of its tiles is used
+struct PagedTileArea {
+	OTB::Node node;
+	uint16_t x;
+	uint16_t y;
+	uint8_t z;
+};
 
+struct StagedTown {
+	uint32_t id;
+	std::string name;
+	Position templePos;
+};
+
+class IOMap {
 	public:
 		bool loadMap(Map* map, const std::filesystem::path& fileName);
 
+		// reads the map file without touching the game, so it can run next to other startup work
+		// the world map is cached with its spawns and houses by useWorldCache, see decodeMap in iomap.cpp
+		bool decodeMap(const std::filesystem::path& fileName, bool paging = false, bool world = false);
+		// puts a decoded map into the game, on the dispatcher thread
+		void commitMap(Map* map);
+
 		/* Load the spawns
 		 * \param map pointer to the Map class
 		 * \returns Returns true if the spawns were loaded successfully
 		 */
-		static bool loadSpawns(Map* map, bool isCalledByLua) {
-			if (map->spawnfile.empty()) {
-				//OTBM file doesn't tell us about the spawnfile,
-				//lets guess it is mapname-spawn.xml.
-				map->spawnfile = getString(ConfigManager::MAP_NAME);
-				map->spawnfile += "-spawn.xml";
-			}
-
-			return map->spawns.loadFromXml(map->spawnfile.string(), isCalledByLua);
-		}
+		bool loadSpawns(Map* map, bool isCalledByLua);
 
 		/* Load the houses (not house tile-data)
 		 * \param map pointer to the Map class
 		 * \returns Returns true if the houses were loaded successfully
 		 */
-		static bool loadHouses(Map* map) {
-			if (map->housefile.empty()) {
-				//OTBM file doesn't tell us about the housefile,
-				//lets guess it is mapname-house.xml.
-				map->housefile = getString(ConfigManager::MAP_NAME);
-				map->housefile += "-house.xml";
-			}
-
-			return map->houses.loadHousesXML(map->housefile.string());
-		}
+		bool loadHouses(Map* map);
 
 		const std::string& getLastErrorString() const {
 			return errorString;
@@ -128,11 +149,106 @@ class IOMap {
 		}
 
 	private:
-		bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, const std::filesystem::path& fileName);
-		bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map);
-		bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map);
-		bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map);
+		bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, const std::filesystem::path& fileName);
+		bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode);
+		bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode);
+		// leaves the nodes of the tile areas that were decoded in tileAreaNodes
+		bool parseTileAreas(OTB::Loader& loader, std::vector<OTB::Node>& tileAreaNodes, bool paging);
+		bool parseFlatTileAreas(const std::vector<std::string_view>& flatAreas);
+		bool checkTileAreas();
+
+		bool readWorldCache(const std::filesystem::path& cacheFile, uint64_t key, const OTB::Loader& loader, std::string& cache, std::vector<std::string_view>& flatAreas);
+		void writeWorldCache(const std::filesystem::path& cacheFile, uint64_t key, const OTB::Loader& loader, const std::vector<OTB::Node>& tileAreaNodes);
+
+		std::vector<StagedTileArea> areas;
+		std::vector<PagedTileArea> pagedAreas;
+		std::optional<OTB::Loader> pagingLoader;
+		std::vector<StagedTown> towns;
+		std::vector<std::pair<std::string, Position>> waypoints;
+		std::optional<std::vector<SpawnRecord>> spawnRecords;
+		std::optional<std::vector<HouseRecord>> houseRecords;
+		std::filesystem::path spawnFile;
+		std::filesystem::path houseFile;
+		uint32_t width = 0;
+		uint32_t height = 0;
 		std::string errorString;
 };
 
+struct MapPagerStats {
+	size_t regions = 0;
+	size_t loadedRegions = 0;
+	size_t pinnedRegions = 0;
+	size_t changedRegions = 0;
+	uint64_t loads = 0;
+	uint64_t unloads = 0;
+};
+
+/*
+* with mapPaging the map is split in regions of 256x256 tiles of one floor, the tile areas of a region stay in the file
+* until one of its tiles is asked for and the region is dropped again once it has been idle for mapRegionIdleTime
+* regions with house tiles are always loaded, regions whose items from the file changed are never dropped
+* and a region is kept as long as the game still points into one of its tiles (see Game::canReleaseTile)
+*/
+class MapPager {
+	public:
+		static constexpr int32_t REGION_BITS = 8;
+		static constexpr int32_t REGION_SIZE = 1 << REGION_BITS;
+
+		MapPager(Map& map, OTB::Loader loader);
+
+		// non-copyable
+		MapPager(const MapPager&) = delete;
+		MapPager& operator=(const MapPager&) = delete;
+
+		void addTileArea(const PagedTileArea& tileArea);
+
+		// decodes the region of a position if it is not loaded, returns true if tiles were added
+		bool loadRegion(uint16_t x, uint16_t y, uint8_t z);
+		// loads the region and keeps it, e.g. when another map file is loaded on top of it
+		void pinRegion(uint16_t x, uint16_t y, uint8_t z);
+		void setRegionChanged(uint16_t x, uint16_t y, uint8_t z);
+		void unloadIdleRegions(int64_t idleTime);
+
+		// called on every tile lookup, folded into the idle time by unloadIdleRegions
+		void touchRegion(uint16_t x, uint16_t y, uint8_t z) {
+			if (uint32_t index = regionIndex[getRegionKey(x, y, z)]) {
+				regions[index - 1].used = true;
+			}
+		}
+
+		MapPagerStats getStats() const;
+
+		static size_t getRegionKey(uint16_t x, uint16_t y, uint8_t z) {
+			return (static_cast<size_t>(z) << 16) | ((x >> REGION_BITS) << 8) | (y >> REGION_BITS);
+		}
+
+	private:
+		struct Region {
+			std::vector<OTB::Node> tileAreas;
+			int64_t lastUsed = 0;
+			uint16_t x = 0;
+			uint16_t y = 0;
+			uint8_t z = 0;
+			bool loaded = false;
+			bool used = false;
+			bool pinned = false;
+			// items decoded from the file were moved or modified, decoding it again would duplicate or revert them
+			bool changed = false;
+		};
+
+		Region* getRegion(uint16_t x, uint16_t y, uint8_t z);
+		bool isRegionInUse(const Region& region, const std::unordered_set<const Tile*>& tilesInUse);
+		void unloadRegion(Region& region);
+
+		Map& map;
+		OTB::Loader loader;
+		// the items of a region being decoded are its file state, their changes do not count
+		const Region* loadingRegion = nullptr;
+		// region key to index + 1 in regions, 0 if the file has no tile area there
+		std::vector<uint32_t> regionIndex;
+		std::vector<Region> regions;
+		uint64_t loads = 0;
+		uint64_t unloads = 0;
+};
+
 #endif // FS_IOMAP_H
\ No newline at end of file
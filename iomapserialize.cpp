@@ -6,90 +6,141 @@
 #include "iomapserialize.h"
 
 #include "bed.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "housetile.h"
 
 extern Game g_game;
+extern Dispatcher g_dispatcher;
 
 void IOMapSerialize::loadHouseItems(Map* map) {
 	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
-	if (!result) {
-		return;
-	}
+	std::set<uint32_t> unknownHouseIds;
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `house_id`, `data` FROM `tile_store`");
+	if (result) {
+		do {
+			// rows of houses that are not on this map are kept, the map or house file may only be wrong for this boot
+			uint32_t houseId = result->getNumber<uint32_t>("house_id");
+			if (!map->houses.getHouse(houseId)) {
+				unknownHouseIds.insert(houseId);
+				continue;
+			}
 
-	do {
-		auto attr = result->getString("data");
+			auto attr = result->getString("data");
 
-		PropStream propStream;
-		propStream.init(attr.data(), attr.size());
+			PropStream propStream;
+			propStream.init(attr.data(), attr.size());
 
-		uint16_t x, y;
-		uint8_t z;
-		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
-			continue;
-		}
+			uint16_t x, y;
+			uint8_t z;
+			if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
+				continue;
+			}
 
-		Tile* tile = map->getTile(x, y, z);
-		if (!tile) {
-			continue;
-		}
+			Tile* tile = map->getTile(x, y, z);
+			if (!tile) {
+				continue;
+			}
 
-		uint32_t item_count;
-		if (!propStream.read<uint32_t>(item_count)) {
-			continue;
-		}
+			uint32_t item_count;
+			if (!propStream.read<uint32_t>(item_count)) {
+				continue;
+			}
+
+			while (item_count--) {
+				loadItem(propStream, tile);
+			}
+		} while (result->next());
+	}
 
-		while (item_count--) {
-			loadItem(propStream, tile);
+	if (!unknownHouseIds.empty()) {
+		std::ostringstream houseIds;
+		for (auto it = unknownHouseIds.begin(); it != unknownHouseIds.end(); ++it) {
+			if (it != unknownHouseIds.begin()) {
+				houseIds << ", ";
+			}
+			houseIds << *it;
 		}
-	} while (result->next());
+		std::cout << "[Warning - IOMapSerialize::loadHouseItems] Skipped stored items of houses not on the map: " << houseIds.str() << std::endl;
+	}
+
+	// the loaded items match the database, only later changes have to be saved
+	for (const auto& it : map->houses.getHouses()) {
+		it.second->setSavedItemRevision(it.second->getItemRevision());
+	}
 	std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
 }
 
 bool IOMapSerialize::saveHouseItems() {
 	int64_t start = OTSYS_TIME();
-	Database& db = Database::getInstance();
 
-	//Start the transaction
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
+	std::vector<std::string> statements;
+	HouseItemRevisions revisions;
+	serializeHouseItems(statements, revisions);
 
-	//clear old tile data
-	if (!db.executeQuery("DELETE FROM `tile_store`")) {
-		return false;
+	bool success = statements.empty() || Database::getInstance().executeTransaction(statements);
+	if (success) {
+		setHouseItemsSaved(revisions);
 	}
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
+	std::cout << "> Saved items of " << revisions.size() << " houses in: " <<
+	          (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+	return success;
+}
 
-	PropWriteStream stream;
+void IOMapSerialize::serializeHouseItems(std::vector<std::string>& statements, HouseItemRevisions& revisions) {
+	g_game.countDecayingHouseItems();
 	for (const auto& it : g_game.map.houses.getHouses()) {
-		//save house items
 		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
-			saveTile(stream, tile);
+		if (house->hasUnsavedItems()) {
+			revisions.emplace_back(house, house->getItemRevision());
+		}
+	}
 
-			if (auto attributes = stream.getStream(); !attributes.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)))) {
-					return false;
-				}
-				stream.clear();
-			}
+	if (revisions.empty()) {
+		return;
+	}
+
+	//clear old tile data of the changed houses
+	std::ostringstream query;
+	query << "DELETE FROM `tile_store` WHERE `house_id` IN (";
+	for (size_t i = 0; i < revisions.size(); ++i) {
+		if (i != 0) {
+			query << ", ";
 		}
+		query << revisions[i].first->getId();
 	}
+	query << ')';
+	statements.push_back(query.str());
 
-	if (!stmt.execute()) {
-		return false;
+	Database& db = Database::getInstance();
+	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ", statements);
+
+	PropWriteStream stream;
+	for (const auto& it : revisions) {
+		serializeHouse(db, stmt, stream, it.first);
 	}
 
-	//End the transaction
-	bool success = transaction.commit();
-	std::cout << "> Saved house items in: " <<
-	          (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
-	return success;
+	stmt.execute();
+}
+
+void IOMapSerialize::setHouseItemsSaved(const HouseItemRevisions& revisions) {
+	// changes made after serializing keep the house unsaved
+	for (const auto& [house, revision] : revisions) {
+		house->setSavedItemRevision(revision);
+	}
+}
+
+void IOMapSerialize::serializeHouse(Database& db, DBInsert& stmt, PropWriteStream& stream, const House* house) {
+	for (HouseTile* tile : house->getTiles()) {
+		saveTile(stream, tile);
+
+		if (auto attributes = stream.getStream(); !attributes.empty()) {
+			stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)));
+			stream.clear();
+		}
+	}
 }
 
 bool IOMapSerialize::loadContainer(PropStream& propStream, Container* container) {
@@ -273,103 +324,89 @@ bool IOMapSerialize::loadHouseInfo() {
 }
 
 bool IOMapSerialize::saveHouseInfo() {
+	std::vector<std::string> statements;
+	serializeHouseInfo(statements);
+	return Database::getInstance().executeTransaction(statements);
+}
+
+void IOMapSerialize::serializeHouseInfo(std::vector<std::string>& statements) {
 	Database& db = Database::getInstance();
 
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
+	statements.emplace_back("DELETE FROM `house_lists`");
 
-	if (!db.executeQuery("DELETE FROM `house_lists`")) {
-		return false;
-	}
+	DBInsert houseStmt("INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ", statements);
+	houseStmt.upsert({"owner", "paid", "warnings", "name", "town_id", "rent", "size", "beds"});
 
 	for (const auto& it : g_game.map.houses.getHouses()) {
 		House* house = it.second;
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `id` = {:d}", house->getId()));
-		if (result) {
-			db.executeQuery(fmt::format("UPDATE `houses` SET `owner` = {:d}, `paid` = {:d}, `warnings` = {:d}, `name` = {:s}, `town_id` = {:d}, `rent` = {:d}, `size` = {:d}, `beds` = {:d} WHERE `id` = {:d}", house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(), db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(), house->getBedCount(), house->getId()));
-		} else {
-			db.executeQuery(fmt::format("INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ({:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d})", house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(), db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(), house->getBedCount()));
-		}
+		houseStmt.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d}", house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(), db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(), house->getBedCount()));
 	}
 
-	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ");
+	houseStmt.execute();
+
+	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ", statements);
 
 	for (const auto& it : g_game.map.houses.getHouses()) {
 		House* house = it.second;
 
 		std::string listText;
 		if (house->getAccessList(GUEST_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), static_cast<int>(GUEST_LIST),
-			                             db.escapeString(listText)))) {
-				return false;
-			}
-
+			stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), static_cast<int>(GUEST_LIST), db.escapeString(listText)));
 			listText.clear();
 		}
 
 		if (house->getAccessList(SUBOWNER_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), static_cast<int>(SUBOWNER_LIST),
-			                             db.escapeString(listText)))) {
-				return false;
-			}
-
+			stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), static_cast<int>(SUBOWNER_LIST), db.escapeString(listText)));
 			listText.clear();
 		}
 
 		for (Door* door : house->getDoors()) {
 			if (door->getAccessList(listText) && !listText.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), door->getDoorId(), db.escapeString(listText)))) {
-					return false;
-				}
-
+				stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), door->getDoorId(), db.escapeString(listText)));
 				listText.clear();
 			}
 		}
 	}
 
-	if (!stmt.execute()) {
-		return false;
-	}
-
-	return transaction.commit();
+	stmt.execute();
 }
 
 bool IOMapSerialize::saveHouse(House* house) {
 	Database& db = Database::getInstance();
 
-	//Start the transaction
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
-
 	uint32_t houseId = house->getId();
 
 	//clear old tile data
-	if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` = {:d}", houseId))) {
-		return false;
-	}
+	std::vector<std::string> statements;
+	statements.push_back(fmt::format("DELETE FROM `tile_store` WHERE `house_id` = {:d}", houseId));
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
+	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ", statements);
 
 	PropWriteStream stream;
-	for (HouseTile* tile : house->getTiles()) {
-		saveTile(stream, tile);
-
-		if (auto attributes = stream.getStream(); attributes.size() > 0) {
-			if (!stmt.addRow(fmt::format("{:d}, {:s}", houseId, db.escapeString(attributes)))) {
-				return false;
-			}
-			stream.clear();
-		}
+	serializeHouse(db, stmt, stream, house);
+	stmt.execute();
+
+	HouseItemRevisions revisions{{house, house->getItemRevision()}};
+
+	// a server save is still being written, keep the order with it
+	if (g_game.hasPendingServerSave()) {
+		g_databaseTasks.addTask([statements = std::move(statements), revisions](Database& db) {
+			bool saved = db.executeTransaction(statements);
+			g_dispatcher.addTask([saved, revisions]() {
+				if (!saved) {
+					std::cout << "[Error - IOMapSerialize::saveHouse] Failed to save house items." << std::endl;
+					return;
+				}
+				setHouseItemsSaved(revisions);
+			});
+		});
+		return true;
 	}
 
-	if (!stmt.execute()) {
+	if (!db.executeTransaction(statements)) {
 		return false;
 	}
 
-	//End the transaction
-	return transaction.commit();
-}
\ No newline at end of file
+	setHouseItemsSaved(revisions);
+	return true;
+}
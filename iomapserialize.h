@@ -6,6 +6,8 @@
 
 class Container;
 class Cylinder;
+class Database;
+class DBInsert;
 class House;
 class Item;
 class Map;
@@ -13,6 +15,9 @@ class PropStream;
 class PropWriteStream;
 class Tile;
 
+// houses and the item revision their serialized tile_store rows were taken at
+using HouseItemRevisions = std::vector<std::pair<House*, uint32_t>>;
+
 class IOMapSerialize {
 	public:
 		static void loadHouseItems(Map* map);
@@ -20,11 +25,16 @@ class IOMapSerialize {
 		static bool loadHouseInfo();
 		static bool saveHouseInfo();
 
+		static void serializeHouseItems(std::vector<std::string>& statements, HouseItemRevisions& revisions);
+		static void setHouseItemsSaved(const HouseItemRevisions& revisions);
+		static void serializeHouseInfo(std::vector<std::string>& statements);
+
 		static bool saveHouse(House* house);
 
 	private:
 		static void saveItem(PropWriteStream& stream, const Item* item);
 		static void saveTile(PropWriteStream& stream, const Tile* tile);
+		static void serializeHouse(Database& db, DBInsert& stmt, PropWriteStream& stream, const House* house);
 
 		static bool loadContainer(PropStream& propStream, Container* container);
 		static bool loadItem(PropStream& propStream, Cylinder* parent);
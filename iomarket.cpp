@@ -14,96 +14,153 @@
 
 extern Game g_game;
 
+namespace {
+
+// the most entries of one side the client shows
+constexpr size_t MARKET_HISTORY_SIZE = 1620;
+
+} // namespace
+
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId) {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}", static_cast<int>(action), itemId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.itemOffers.find({itemId, action});
+	if (it == market.itemOffers.end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
+	for (uint32_t offerId : it->second) {
+		const MarketOfferEx& offerEx = market.offers.at(offerId);
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
+		offer.amount = offerEx.amount;
+		offer.price = offerEx.price;
+		offer.timestamp = offerEx.timestamp + marketOfferDuration;
+		offer.counter = offerEx.counter;
 		offer.itemId = itemId;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
-		} else {
-			offer.playerName = "Anonymous";
-		}
+		offer.playerName = offerEx.playerName;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
 MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId) {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, static_cast<int>(action)));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find({playerId, action});
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (uint32_t offerId : it->second) {
+		const MarketOfferEx& offerEx = market.offers.at(offerId);
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = offerEx.amount;
+		offer.price = offerEx.price;
+		offer.timestamp = offerEx.timestamp + marketOfferDuration;
+		offer.counter = offerEx.counter;
+		offer.itemId = offerEx.itemId;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
 HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t playerId) {
 	HistoryMarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, static_cast<int>(action)));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.history.find(playerId);
+	if (it == market.history.end() || !it->second.loaded) {
 		return offerList;
 	}
 
-	do {
-		HistoryMarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
-
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
-		if (offerState == OFFERSTATE_ACCEPTEDEX) {
-			offerState = OFFERSTATE_ACCEPTED;
+	for (HistoryMarketOffer offer : it->second.getOffers(action)) {
+		if (offer.state == OFFERSTATE_ACCEPTEDEX) {
+			offer.state = OFFERSTATE_ACCEPTED;
 		}
-
-		offer.state = offerState;
-
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
-	if (!result) {
-		return;
+bool IOMarket::loadHistory(uint32_t playerId, std::function<void()> onLoaded) {
+	IOMarket& market = getInstance();
+	auto [it, inserted] = market.history.try_emplace(playerId);
+	if (it->second.loaded) {
+		return true;
+	}
+
+	if (!inserted) {
+		// already being read, the first browse gets the answer
+		return false;
 	}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
+	// queued behind the history rows not yet written, the rows appended meanwhile are newer than any of the result
+	const uint32_t loadId = it->second.loadId = market.nextHistoryLoadId++;
+	// each side is capped on its own, the newest rows of one side must not push the other side out
+	constexpr std::string_view sideQuery = "(SELECT `id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d} ORDER BY `id` DESC LIMIT {:d})";
+	std::string query = fmt::format("{:s} UNION ALL {:s} ORDER BY `id` DESC",
+		fmt::format(sideQuery, playerId, static_cast<int>(MARKETACTION_BUY), MARKET_HISTORY_SIZE),
+		fmt::format(sideQuery, playerId, static_cast<int>(MARKETACTION_SELL), MARKET_HISTORY_SIZE));
+	g_databaseTasks.addTask(std::move(query), [playerId, loadId, onLoaded = std::move(onLoaded)](DBResult_ptr result, bool) {
+		IOMarket& market = getInstance();
+		auto it = market.history.find(playerId);
+		if (it == market.history.end() || it->second.loadId != loadId) {
+			return;
+		}
+
+		PlayerHistory& playerHistory = it->second;
+		if (result) {
+			const size_t saleColumn = result->getColumnIndex("sale");
+			const size_t itemtypeColumn = result->getColumnIndex("itemtype");
+			const size_t amountColumn = result->getColumnIndex("amount");
+			const size_t priceColumn = result->getColumnIndex("price");
+			const size_t expiresAtColumn = result->getColumnIndex("expires_at");
+			const size_t stateColumn = result->getColumnIndex("state");
+
+			do {
+				std::deque<HistoryMarketOffer>& offers = playerHistory.getOffers(static_cast<MarketAction_t>(result->getNumber<uint16_t>(saleColumn)));
+				if (offers.size() >= MARKET_HISTORY_SIZE) {
+					continue;
+				}
+
+				HistoryMarketOffer offer;
+				offer.itemId = result->getNumber<uint16_t>(itemtypeColumn);
+				offer.amount = result->getNumber<uint16_t>(amountColumn);
+				offer.price = result->getNumber<uint32_t>(priceColumn);
+				offer.timestamp = result->getNumber<uint32_t>(expiresAtColumn);
+				offer.state = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>(stateColumn));
+				offers.push_front(offer);
+			} while (result->next());
+		}
+
+		playerHistory.loaded = true;
+		onLoaded();
+	}, true, DATABASE_TASK_MARKET);
+	return false;
+}
+
+void IOMarket::unloadHistory(uint32_t playerId) {
+	getInstance().history.erase(playerId);
+}
+
+void IOMarket::processExpiredOffers(const std::vector<MarketOfferEx>& expiredOffers) {
+	for (const MarketOfferEx& offer : expiredOffers) {
+		if (!IOMarket::moveOfferToHistory(offer.id, OFFERSTATE_EXPIRED)) {
 			continue;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
+		const uint32_t playerId = offer.playerId;
+		const uint16_t amount = offer.amount;
+		if (offer.type == MARKETACTION_SELL) {
+			const ItemType& itemType = Item::items[offer.itemId];
 			if (itemType.id == 0) {
 				continue;
 			}
@@ -151,7 +208,7 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
 				delete player;
 			}
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+			uint64_t totalPrice = static_cast<uint64_t>(offer.price) * amount;
 
 			Player* player = g_game.getPlayerByGUID(playerId);
 			if (player) {
@@ -160,13 +217,19 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
 				IOLoginData::increaseBankBalance(playerId, totalPrice);
 			}
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers() {
 	const time_t lastExpireDate = time(nullptr) - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(fmt::format("SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}", lastExpireDate), IOMarket::processExpiredOffers, true);
+	std::vector<MarketOfferEx> expiredOffers;
+	for (const auto& it : getInstance().offers) {
+		if (it.second.timestamp <= lastExpireDate) {
+			expiredOffers.push_back(it.second);
+		}
+	}
+	processExpiredOffers(expiredOffers);
 
 	int32_t checkExpiredMarketOffersEachMinutes = getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -177,94 +240,222 @@ void IOMarket::checkExpiredOffers() {
 }
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
-		return 0;
+	IOMarket& market = getInstance();
+
+	uint32_t count = 0;
+	for (MarketAction_t action : {MARKETACTION_BUY, MARKETACTION_SELL}) {
+		auto it = market.playerOffers.find({playerId, action});
+		if (it != market.playerOffers.end()) {
+			count += it->second.size();
+		}
 	}
-	return result->getNumber<int32_t>("count");
+	return count;
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter) {
 	MarketOfferEx offer;
 
-	const int32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1", created, counter));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.offerCounters.find({created, counter});
+	if (it == market.offerCounters.end()) {
 		offer.id = 0;
 		offer.playerId = 0;
 		return offer;
 	}
-
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint32_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
-	} else {
-		offer.playerName = "Anonymous";
-	}
-	return offer;
+	return market.offers.at(it->second);
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
-	Database::getInstance().executeQuery(fmt::format("INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, time(nullptr), anonymous));
+void IOMarket::createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
+	IOMarket& market = getInstance();
+
+	MarketOfferEx offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.timestamp = time(nullptr);
+	offer.price = price;
+	offer.amount = amount;
+	offer.counter = offer.id & 0xFFFF;
+	offer.itemId = itemId;
+	offer.type = action;
+	offer.playerName = anonymous ? "Anonymous" : playerName;
+
+	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", offer.id, playerId, static_cast<int>(action), itemId, amount, price, offer.timestamp, anonymous ? 1 : 0), nullptr, false, DATABASE_TASK_MARKET);
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	MarketOfferEx& offer = it->second;
+	offer.amount -= std::min(amount, offer.amount);
+	g_databaseTasks.addTask(fmt::format("UPDATE `market_offers` SET `amount` = {:d} WHERE `id` = {:d}", offer.amount, offerId), nullptr, false, DATABASE_TASK_MARKET);
 }
 
 void IOMarket::deleteOffer(uint32_t offerId) {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	market.removeOffer(it->second);
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId), nullptr, false, DATABASE_TASK_MARKET);
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state) {
-	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, timestamp, time(nullptr), static_cast<int>(state)));
+	HistoryMarketOffer offer;
+	offer.timestamp = timestamp;
+	offer.price = price;
+	offer.itemId = itemId;
+	offer.amount = amount;
+	offer.state = state;
+	IOMarket& market = getInstance();
+	market.addStatistics(action, offer);
+
+	auto it = market.history.find(playerId);
+	if (it != market.history.end()) {
+		std::deque<HistoryMarketOffer>& offers = it->second.getOffers(action);
+		offers.push_back(offer);
+		if (offers.size() > MARKET_HISTORY_SIZE) {
+			offers.pop_front();
+		}
+	}
+
+	// an accepted offer appends the rows of both sides in a row, they are written as one insert
+	g_databaseTasks.addBatchedInsert(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, timestamp, time(nullptr), static_cast<int>(state)), DATABASE_TASK_MARKET);
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state) {
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return false;
+	}
+
+	const MarketOfferEx offer = it->second;
+	deleteOffer(offerId);
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price, offer.timestamp + marketOfferDuration, state);
+	return true;
+}
+
+void IOMarket::load() {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}", offerId));
-	if (!result) {
-		return false;
+	offers.clear();
+	itemOffers.clear();
+	playerOffers.clear();
+	offerCounters.clear();
+	history.clear();
+	purchaseStatistics.clear();
+	saleStatistics.clear();
+	nextOfferId = 1;
+
+	if (DBResult_ptr result = db.storeQuery("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers`")) {
+		const size_t idColumn = result->getColumnIndex("id");
+		const size_t saleColumn = result->getColumnIndex("sale");
+		const size_t itemtypeColumn = result->getColumnIndex("itemtype");
+		const size_t amountColumn = result->getColumnIndex("amount");
+		const size_t createdColumn = result->getColumnIndex("created");
+		const size_t priceColumn = result->getColumnIndex("price");
+		const size_t playerIdColumn = result->getColumnIndex("player_id");
+		const size_t anonymousColumn = result->getColumnIndex("anonymous");
+		const size_t playerNameColumn = result->getColumnIndex("player_name");
+
+		do {
+			MarketOfferEx offer;
+			offer.id = result->getNumber<uint32_t>(idColumn);
+			offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>(saleColumn));
+			offer.amount = result->getNumber<uint16_t>(amountColumn);
+			offer.counter = offer.id & 0xFFFF;
+			offer.timestamp = result->getNumber<uint32_t>(createdColumn);
+			offer.price = result->getNumber<uint32_t>(priceColumn);
+			offer.itemId = result->getNumber<uint16_t>(itemtypeColumn);
+			offer.playerId = result->getNumber<uint32_t>(playerIdColumn);
+			if (result->getNumber<uint16_t>(anonymousColumn) == 0) {
+				offer.playerName = result->getString(playerNameColumn);
+			} else {
+				offer.playerName = "Anonymous";
+			}
+
+			nextOfferId = std::max(nextOfferId, offer.id + 1);
+			addOffer(std::move(offer));
+		} while (result->next());
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
+	// the history itself is read per player on demand, only the statistics cover all of it
+	if (DBResult_ptr result = db.storeQuery(fmt::format("SELECT `sale`, `itemtype`, COUNT(*) AS `count`, MIN(`price`) AS `lowest`, MAX(`price`) AS `highest`, SUM(`price`) AS `total` FROM `market_history` WHERE `state` = {:d} GROUP BY `sale`, `itemtype`", static_cast<int>(OFFERSTATE_ACCEPTED)))) {
+		const size_t saleColumn = result->getColumnIndex("sale");
+		const size_t itemtypeColumn = result->getColumnIndex("itemtype");
+		const size_t countColumn = result->getColumnIndex("count");
+		const size_t lowestColumn = result->getColumnIndex("lowest");
+		const size_t highestColumn = result->getColumnIndex("highest");
+		const size_t totalColumn = result->getColumnIndex("total");
+
+		do {
+			const auto type = static_cast<MarketAction_t>(result->getNumber<uint16_t>(saleColumn));
+			MarketStatistics& statistics = (type == MARKETACTION_BUY ? purchaseStatistics : saleStatistics)[result->getNumber<uint16_t>(itemtypeColumn)];
+			statistics.numTransactions = result->getNumber<uint32_t>(countColumn);
+			statistics.lowestPrice = result->getNumber<uint32_t>(lowestColumn);
+			statistics.highestPrice = result->getNumber<uint32_t>(highestColumn);
+			statistics.totalPrice = result->getNumber<uint64_t>(totalColumn);
+		} while (result->next());
 	}
+}
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint32_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
-	return true;
+void IOMarket::addOffer(MarketOfferEx&& offer) {
+	const uint32_t offerId = offer.id;
+	itemOffers[{offer.itemId, offer.type}].insert(offerId);
+	playerOffers[{offer.playerId, offer.type}].insert(offerId);
+	offerCounters[{offer.timestamp, offer.counter}] = offerId;
+	offers[offerId] = std::move(offer);
 }
 
-void IOMarket::updateStatistics() {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`", static_cast<int>(OFFERSTATE_ACCEPTED)));
-	if (!result) {
-		return;
+void IOMarket::removeOffer(const MarketOfferEx& offer) {
+	auto itemIt = itemOffers.find({offer.itemId, offer.type});
+	if (itemIt != itemOffers.end()) {
+		itemIt->second.erase(offer.id);
+		if (itemIt->second.empty()) {
+			itemOffers.erase(itemIt);
+		}
 	}
 
-	do {
-		MarketStatistics* statistics;
-		if (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
-			statistics = &purchaseStatistics[result->getNumber<uint16_t>("itemtype")];
-		} else {
-			statistics = &saleStatistics[result->getNumber<uint16_t>("itemtype")];
+	auto playerIt = playerOffers.find({offer.playerId, offer.type});
+	if (playerIt != playerOffers.end()) {
+		playerIt->second.erase(offer.id);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
 		}
+	}
+
+	auto counterIt = offerCounters.find({offer.timestamp, offer.counter});
+	if (counterIt != offerCounters.end() && counterIt->second == offer.id) {
+		offerCounters.erase(counterIt);
+	}
+
+	offers.erase(offer.id);
+}
 
-		statistics->numTransactions = result->getNumber<uint32_t>("num");
-		statistics->lowestPrice = result->getNumber<uint32_t>("min");
-		statistics->totalPrice = result->getNumber<uint64_t>("sum");
-		statistics->highestPrice = result->getNumber<uint32_t>("max");
-	} while (result->next());
+void IOMarket::addStatistics(MarketAction_t type, const HistoryMarketOffer& offer) {
+	if (offer.state != OFFERSTATE_ACCEPTED) {
+		return;
+	}
+
+	// statistics only count the side of the offer owner, accepting players get OFFERSTATE_ACCEPTEDEX
+	MarketStatistics& statistics = (type == MARKETACTION_BUY ? purchaseStatistics : saleStatistics)[offer.itemId];
+	if (statistics.numTransactions == 0 || offer.price < statistics.lowestPrice) {
+		statistics.lowestPrice = offer.price;
+	}
+	statistics.highestPrice = std::max(statistics.highestPrice, offer.price);
+	statistics.totalPrice += offer.price;
+	++statistics.numTransactions;
 }
 
 MarketStatistics* IOMarket::getPurchaseStatistics(uint16_t itemId) {
@@ -18,20 +18,25 @@ class IOMarket {
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
+		// the history of a player is read on the first browse, returns false and calls onLoaded once it arrived
+		static bool loadHistory(uint32_t playerId, std::function<void()> onLoaded);
+		static void unloadHistory(uint32_t playerId);
+
+		static void processExpiredOffers(const std::vector<MarketOfferEx>& expiredOffers);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
 		static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-		static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
+		static void createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
 		static void acceptOffer(uint32_t offerId, uint16_t amount);
 		static void deleteOffer(uint32_t offerId);
 
 		static void appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state);
 		static bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state);
 
-		void updateStatistics();
+		// reads the offers and the statistics once, afterwards the market is served from memory and written behind
+		void load();
 
 		MarketStatistics* getPurchaseStatistics(uint16_t itemId);
 		MarketStatistics* getSaleStatistics(uint16_t itemId);
@@ -39,6 +44,30 @@ class IOMarket {
 	private:
 		IOMarket() = default;
 
+		void addOffer(MarketOfferEx&& offer);
+		void removeOffer(const MarketOfferEx& offer);
+		void addStatistics(MarketAction_t type, const HistoryMarketOffer& offer);
+
+		// the newest entries of each side, kept while the player is online after browsing them
+		struct PlayerHistory {
+			std::deque<HistoryMarketOffer> buyOffers;
+			std::deque<HistoryMarketOffer> sellOffers;
+			uint32_t loadId = 0;
+			bool loaded = false;
+
+			std::deque<HistoryMarketOffer>& getOffers(MarketAction_t type) {
+				return type == MARKETACTION_BUY ? buyOffers : sellOffers;
+			}
+		};
+
+		std::map<uint32_t, MarketOfferEx> offers;
+		std::map<std::pair<uint16_t, MarketAction_t>, std::set<uint32_t>> itemOffers;
+		std::map<std::pair<uint32_t, MarketAction_t>, std::set<uint32_t>> playerOffers;
+		std::map<std::pair<uint32_t, uint16_t>, uint32_t> offerCounters;
+		std::unordered_map<uint32_t, PlayerHistory> history;
+		uint32_t nextOfferId = 1;
+		uint32_t nextHistoryLoadId = 1;
+
 		std::map<uint16_t, MarketStatistics> purchaseStatistics;
 		std::map<uint16_t, MarketStatistics> saleStatistics;
 };
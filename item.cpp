@@ -20,6 +20,15 @@ extern Spells* g_spells;
 extern Vocations g_vocations;
 
 Items Item::items;
+thread_local std::vector<std::function<void()>>* Item::deferredGameCalls = nullptr;
+
+void Item::callGame(std::function<void()>&& call) {
+	if (deferredGameCalls) {
+		deferredGameCalls->push_back(std::move(call));
+	} else {
+		call();
+	}
+}
 
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/) {
 	Item* newItem = nullptr;
@@ -180,34 +189,7 @@ bool Item::equals(const Item* otherItem) const {
 		return (attributes->attributeBits == 0);
 	}
 
-	if (attributes->attributeBits != otherAttributes->attributeBits) {
-		return false;
-	}
-
-	const auto& attributeList = attributes->attributes;
-	const auto& otherAttributeList = otherAttributes->attributes;
-	for (const auto& attribute : attributeList) {
-		if (ItemAttributes::isIntAttrType(attribute.type)) {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && attribute.value.integer != otherAttribute.value.integer) {
-					return false;
-				}
-			}
-		} else if (ItemAttributes::isStrAttrType(attribute.type)) {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && *attribute.value.string != *otherAttribute.value.string) {
-					return false;
-				}
-			}
-		} else {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && *attribute.value.custom != *otherAttribute.value.custom) {
-					return false;
-				}
-			}
-		}
-	}
-	return true;
+	return *attributes == *otherAttributes;
 }
 
 void Item::setDefaultSubtype() {
@@ -322,6 +304,60 @@ const Player* Item::getHoldingPlayer() const {
 	return dynamic_cast<const Player*>(getTopParent());
 }
 
+void Item::updateParentWeight(int32_t diff) {
+	Cylinder* parent = getParent();
+	if (!parent || diff == 0) {
+		return;
+	}
+
+	if (Container* container = parent->getContainer()) {
+		container->updateItemWeight(diff);
+	} else if (Creature* creature = parent->getCreature()) {
+		if (Player* player = creature->getPlayer()) {
+			player->addInventoryWeight(diff);
+		}
+	}
+}
+
+const Item* Item::getMapTopItem() const {
+	// items carried by creatures or kept in a depot are not part of the map
+	const Item* topItem = dynamic_cast<const Item*>(getTopParent());
+	if (!topItem) {
+		return nullptr;
+	}
+
+	const Container* topContainer = topItem->getContainer();
+	if (topContainer && topContainer->getDepotLocker()) {
+		return nullptr;
+	}
+	return topItem;
+}
+
+House* Item::getMapHouse() const {
+	if (!getMapTopItem()) {
+		return nullptr;
+	}
+
+	const Tile* tile = getTile();
+	return tile ? tile->getHouse() : nullptr;
+}
+
+void Item::notifyHouseChange() {
+	const Item* topItem = getMapTopItem();
+	if (!topItem) {
+		return;
+	}
+
+	if (Tile* tile = getTile()) {
+		if (House* house = tile->getHouse()) {
+			house->onItemChange();
+		} else if (topItem->isLoadedFromMap()) {
+			// only the items on the tile itself are flagged as loaded from the map, the others are kept by the pager anyway
+			g_game.map.setRegionChanged(tile->getPosition());
+		}
+	}
+}
+
 void Item::setSubType(uint16_t n) {
 	const ItemType& it = items[id];
 	if (it.isFluidContainer() || it.isSplash()) {
@@ -364,7 +400,7 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream) {
 				return ATTR_READ_ERROR;
 			}
 
-			setUniqueId(uniqueId);
+			callGame([this, uniqueId]() { setUniqueId(uniqueId); });
 			break;
 		}
 
@@ -1620,16 +1656,59 @@ int64_t ItemAttributes::emptyInt;
 double ItemAttributes::emptyDouble;
 bool ItemAttributes::emptyBool;
 
+namespace {
+
+	struct StringPool {
+		std::mutex lock;
+		std::unordered_map<std::string_view, std::weak_ptr<const std::string>> strings;
+	};
+
+	// never destroyed, items freed during shutdown still remove their strings from it
+	StringPool& getStringPool() {
+		static StringPool* pool = new StringPool;
+		return *pool;
+	}
+
+} // namespace
+
+ItemAttributes::SharedString ItemAttributes::internString(std::string_view value) {
+	StringPool& pool = getStringPool();
+	std::lock_guard<std::mutex> lockClass(pool.lock);
+	auto it = pool.strings.find(value);
+	if (it != pool.strings.end()) {
+		if (SharedString string = it->second.lock()) {
+			return string;
+		}
+		// its last user is being destroyed right now and waits for the lock
+		pool.strings.erase(it);
+	}
+
+	SharedString string(new std::string(value), [](const std::string* string) {
+		StringPool& pool = getStringPool();
+		{
+			std::lock_guard<std::mutex> lockClass(pool.lock);
+			auto it = pool.strings.find(*string);
+			if (it != pool.strings.end() && it->first.data() == string->data()) {
+				pool.strings.erase(it);
+			}
+		}
+		delete string;
+	});
+	pool.strings.emplace(*string, string);
+	return string;
+}
+
 const std::string& ItemAttributes::getStrAttr(itemAttrTypes type) const {
-	if (!isStrAttrType(type)) {
+	if (!isStrAttrType(type) || !hasAttribute(type)) {
 		return emptyString;
 	}
 
-	const Attribute* attr = getExistingAttr(type);
-	if (!attr) {
-		return emptyString;
+	for (const auto& [attrType, value] : rare->strings) {
+		if (attrType == type) {
+			return *value;
+		}
 	}
-	return *attr->value.string;
+	return emptyString;
 }
 
 void ItemAttributes::setStrAttr(itemAttrTypes type, std::string_view value) {
@@ -1641,9 +1720,19 @@ void ItemAttributes::setStrAttr(itemAttrTypes type, std::string_view value) {
 		return;
 	}
 
-	Attribute& attr = getAttr(type);
-	delete attr.value.string;
-	attr.value.string = new std::string(value);
+	SharedString string = internString(value);
+	auto& strings = getRare().strings;
+	if (hasAttribute(type)) {
+		for (auto& [attrType, attrValue] : strings) {
+			if (attrType == type) {
+				attrValue = std::move(string);
+				return;
+			}
+		}
+	}
+
+	strings.emplace_back(type, std::move(string));
+	attributeBits |= type;
 }
 
 void ItemAttributes::removeAttribute(itemAttrTypes type) {
@@ -1651,32 +1740,48 @@ void ItemAttributes::removeAttribute(itemAttrTypes type) {
 		return;
 	}
 
-	auto prev_it = attributes.rbegin();
-	if ((*prev_it).type == type) {
-		attributes.pop_back();
-	} else {
-		auto it = prev_it, end = attributes.rend();
-		while (++it != end) {
-			if ((*it).type == type) {
-				(*it) = attributes.back();
-				attributes.pop_back();
+	attributeBits &= ~type;
+	if (isCommonIntAttrType(type)) {
+		commonIntegers[getCommonSlot(type)] = 0;
+		return;
+	}
+
+	auto eraseAttr = [type](auto& attrs) {
+		for (auto it = attrs.begin(), end = attrs.end(); it != end; ++it) {
+			if (it->first == type) {
+				*it = std::move(attrs.back());
+				attrs.pop_back();
 				break;
 			}
 		}
+	};
+
+	if (isIntAttrType(type)) {
+		eraseAttr(rare->integers);
+	} else if (isStrAttrType(type)) {
+		eraseAttr(rare->strings);
+	} else {
+		rare->custom.clear();
 	}
-	attributeBits &= ~type;
+
+	releaseRare();
 }
 
 int64_t ItemAttributes::getIntAttr(itemAttrTypes type) const {
-	if (!isIntAttrType(type)) {
+	if (!isIntAttrType(type) || !hasAttribute(type)) {
 		return 0;
 	}
 
-	const Attribute* attr = getExistingAttr(type);
-	if (!attr) {
-		return 0;
+	if (isCommonIntAttrType(type)) {
+		return commonIntegers[getCommonSlot(type)];
+	}
+
+	for (const auto& [attrType, value] : rare->integers) {
+		if (attrType == type) {
+			return value;
+		}
 	}
-	return attr->value.integer;
+	return 0;
 }
 
 void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value) {
@@ -1688,36 +1793,51 @@ void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value) {
 		value = 100;
 	}
 
-	getAttr(type).value.integer = value;
+	if (isCommonIntAttrType(type)) {
+		commonIntegers[getCommonSlot(type)] = value;
+		attributeBits |= type;
+		return;
+	}
+
+	auto& integers = getRare().integers;
+	if (hasAttribute(type)) {
+		for (auto& [attrType, attrValue] : integers) {
+			if (attrType == type) {
+				attrValue = value;
+				return;
+			}
+		}
+	}
+
+	integers.emplace_back(type, value);
+	attributeBits |= type;
 }
 
 void ItemAttributes::increaseIntAttr(itemAttrTypes type, int64_t value) {
 	setIntAttr(type, getIntAttr(type) + value);
 }
 
-const ItemAttributes::Attribute* ItemAttributes::getExistingAttr(itemAttrTypes type) const {
-	if (hasAttribute(type)) {
-		for (const Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return &attribute;
-			}
-		}
+bool ItemAttributes::operator==(const ItemAttributes& other) const {
+	if (attributeBits != other.attributeBits || commonIntegers != other.commonIntegers) {
+		return false;
 	}
-	return nullptr;
-}
 
-ItemAttributes::Attribute& ItemAttributes::getAttr(itemAttrTypes type) {
-	if (hasAttribute(type)) {
-		for (Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return attribute;
-			}
+	if (!rare) {
+		return true;
+	}
+
+	for (const auto& [type, value] : rare->integers) {
+		if (other.getIntAttr(type) != value) {
+			return false;
 		}
 	}
 
-	attributeBits |= type;
-	attributes.emplace_back(type);
-	return attributes.back();
+	for (const auto& [type, value] : rare->strings) {
+		if (other.getStrAttr(type) != *value) {
+			return false;
+		}
+	}
+	return !hasAttribute(ITEM_ATTRIBUTE_CUSTOM) || rare->custom == other.rare->custom;
 }
 
 void Item::startDecaying() {
@@ -1729,22 +1849,14 @@ bool Item::hasMarketAttributes() const {
 		return true;
 	}
 
-	for (const auto& attr : attributes->getList()) {
-		if (attr.type == ITEM_ATTRIBUTE_CHARGES) {
-			uint16_t charges = static_cast<uint16_t>(attr.value.integer);
-			if (charges != items[id].charges) {
-				return false;
-			}
-		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration != getDefaultDuration()) {
-				return false;
-			}
-		} else {
-			return false;
-		}
+	if ((attributes->attributeBits & ~(ITEM_ATTRIBUTE_CHARGES | ITEM_ATTRIBUTE_DURATION)) != 0) {
+		return false;
 	}
-	return true;
+
+	if (hasAttribute(ITEM_ATTRIBUTE_CHARGES) && static_cast<uint16_t>(getIntAttr(ITEM_ATTRIBUTE_CHARGES)) != items[id].charges) {
+		return false;
+	}
+	return !hasAttribute(ITEM_ATTRIBUTE_DURATION) || static_cast<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION)) == getDefaultDuration();
 }
 
 template<>
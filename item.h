@@ -7,11 +7,13 @@
 #include "cylinder.h"
 #include "items.h"
 #include "luascript.h"
+#include "slab.h"
 #include "thing.h"
 
 class BedItem;
 class Container;
 class Door;
+class House;
 class MagicField;
 class Mailbox;
 class Player;
@@ -99,6 +101,11 @@ enum Attr_ReadValue {
 class ItemAttributes {
 	public:
 		ItemAttributes() = default;
+		ItemAttributes(const ItemAttributes& other) :
+			commonIntegers(other.commonIntegers), rare(other.rare ? new RareAttributes(*other.rare) : nullptr), attributeBits(other.attributeBits) {}
+
+		// non-assignable
+		ItemAttributes& operator=(const ItemAttributes&) = delete;
 
 		void setSpecialDescription(const std::string& desc) {
 			setStrAttr(ITEM_ATTRIBUTE_DESCRIPTION, desc);
@@ -340,70 +347,45 @@ class ItemAttributes {
 
 		typedef std::unordered_map<std::string, CustomAttribute> CustomAttributeMap;
 
-		struct Attribute {
-			union {
-				int64_t integer;
-				std::string* string;
-				CustomAttributeMap* custom;
-			} value;
-			itemAttrTypes type;
+		// identical texts and descriptions share one string
+		using SharedString = std::shared_ptr<const std::string>;
+		static SharedString internString(std::string_view value);
 
-			explicit Attribute(itemAttrTypes type) : type(type) {
-				memset(&value, 0, sizeof(value));
-			}
-			Attribute(const Attribute& i) {
-				type = i.type;
-				if (ItemAttributes::isIntAttrType(type)) {
-					value.integer = i.value.integer;
-				} else if (ItemAttributes::isStrAttrType(type)) {
-					value.string = new std::string(*i.value.string);
-				} else if (ItemAttributes::isCustomAttrType(type)) {
-					value.custom = new CustomAttributeMap(*i.value.custom);
-				} else {
-					memset(&value, 0, sizeof(value));
-				}
-			}
-			Attribute(Attribute&& attribute) : value(attribute.value), type(attribute.type) {
-				memset(&attribute.value, 0, sizeof(value));
-				attribute.type = ITEM_ATTRIBUTE_NONE;
-			}
-			~Attribute() {
-				if (ItemAttributes::isStrAttrType(type)) {
-					delete value.string;
-				} else if (ItemAttributes::isCustomAttrType(type)) {
-					delete value.custom;
-				}
-			}
-			Attribute& operator=(Attribute other) {
-				Attribute::swap(*this, other);
-				return *this;
-			}
-			Attribute& operator=(Attribute&& other) {
-				if (this != &other) {
-					if (ItemAttributes::isStrAttrType(type)) {
-						delete value.string;
-					} else if (ItemAttributes::isCustomAttrType(type)) {
-						delete value.custom;
-					}
-
-					value = other.value;
-					type = other.type;
+		// the integer attributes most items carry have a slot of their own, in the order of their bits
+		const static uint32_t commonIntAttributeTypes = ITEM_ATTRIBUTE_ACTIONID | ITEM_ATTRIBUTE_UNIQUEID | ITEM_ATTRIBUTE_DURATION
+			| ITEM_ATTRIBUTE_DECAYSTATE | ITEM_ATTRIBUTE_CHARGES;
 
-					memset(&other.value, 0, sizeof(value));
-					other.type = ITEM_ATTRIBUTE_NONE;
-				}
-				return *this;
-			}
+		static bool isCommonIntAttrType(itemAttrTypes type) {
+			return type != ITEM_ATTRIBUTE_NONE && (type & commonIntAttributeTypes) == type;
+		}
+		static size_t getCommonSlot(itemAttrTypes type) {
+			return std::popcount(commonIntAttributeTypes & (type - 1));
+		}
 
-			static void swap(Attribute& first, Attribute& second) {
-				std::swap(first.value, second.value);
-				std::swap(first.type, second.type);
-			}
+		// everything else is only allocated once an item uses it
+		struct RareAttributes {
+			std::vector<std::pair<itemAttrTypes, int64_t>> integers;
+			std::vector<std::pair<itemAttrTypes, SharedString>> strings;
+			CustomAttributeMap custom;
 		};
 
-		std::vector<Attribute> attributes;
+		std::array<int64_t, std::popcount(commonIntAttributeTypes)> commonIntegers = {};
+		std::unique_ptr<RareAttributes> rare;
 		uint32_t attributeBits = 0;
 
+		RareAttributes& getRare() {
+			if (!rare) {
+				rare.reset(new RareAttributes);
+			}
+			return *rare;
+		}
+		// only drop the rare attributes once no bit refers to them anymore
+		void releaseRare() {
+			if ((attributeBits & ~commonIntAttributeTypes) == 0) {
+				rare.reset();
+			}
+		}
+
 		const std::string& getStrAttr(itemAttrTypes type) const;
 		void setStrAttr(itemAttrTypes type, std::string_view value);
 
@@ -411,15 +393,12 @@ class ItemAttributes {
 		void setIntAttr(itemAttrTypes type, int64_t value);
 		void increaseIntAttr(itemAttrTypes type, int64_t value);
 
-		const Attribute* getExistingAttr(itemAttrTypes type) const;
-		Attribute& getAttr(itemAttrTypes type);
-
 		CustomAttributeMap* getCustomAttributeMap() {
 			if (!hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
 				return nullptr;
 			}
 
-			return getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom;
+			return &rare->custom;
 		}
 
 		template<typename R>
@@ -435,23 +414,17 @@ class ItemAttributes {
 
 		template<typename R>
 		void setCustomAttribute(std::string_view key, R value) {
-			if (hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
-				removeCustomAttribute(key);
-			} else {
-				getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom = new CustomAttributeMap();
-			}
+			removeCustomAttribute(key);
+			attributeBits |= ITEM_ATTRIBUTE_CUSTOM;
 			auto lowercaseKey = boost::algorithm::to_lower_copy(std::string{key});
-			getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom->emplace(lowercaseKey, value);
+			getRare().custom.emplace(lowercaseKey, value);
 		}
 
 		void setCustomAttribute(std::string_view key, const CustomAttribute& value) {
-			if (hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
-				removeCustomAttribute(key);
-			} else {
-				getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom = new CustomAttributeMap();
-			}
+			removeCustomAttribute(key);
+			attributeBits |= ITEM_ATTRIBUTE_CUSTOM;
 			auto lowercaseKey = boost::algorithm::to_lower_copy(std::string{key});
-			getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom->emplace(lowercaseKey, value);
+			getRare().custom.emplace(lowercaseKey, value);
 		}
 
 		const CustomAttribute* getCustomAttribute(int64_t key) {
@@ -479,6 +452,10 @@ class ItemAttributes {
 				auto lowercaseKey = boost::algorithm::to_lower_copy(std::string{key});
 				if (auto it = customAttrMap->find(lowercaseKey); it != customAttrMap->end()) {
 					customAttrMap->erase(it);
+					if (customAttrMap->empty()) {
+						attributeBits &= ~ITEM_ATTRIBUTE_CUSTOM;
+						releaseRare();
+					}
 					return true;
 				}
 			}
@@ -505,9 +482,7 @@ class ItemAttributes {
 			return (type & ITEM_ATTRIBUTE_CUSTOM) == type;
 		}
 
-		const std::vector<Attribute>& getList() const {
-			return attributes;
-		}
+		bool operator==(const ItemAttributes& other) const;
 
 	friend class Item;
 };
@@ -520,6 +495,10 @@ class Item : virtual public Thing {
 		static Item* CreateItem(PropStream& propStream);
 		static Items items;
 
+		// set on map loading threads, calls into the game made while reading items are queued and replayed in map order
+		static thread_local std::vector<std::function<void()>>* deferredGameCalls;
+		static void callGame(std::function<void()>&& call);
+
 		// Constructor for items
 		Item(const uint16_t type, uint16_t count = 0);
 		Item(const Item& i);
@@ -527,6 +506,14 @@ class Item : virtual public Thing {
 
 		virtual ~Item() = default;
 
+		static void* operator new(size_t size) {
+			return SlabAllocator<Item>::allocate(size);
+		}
+
+		static void operator delete(void* p, size_t size) {
+			SlabAllocator<Item>::deallocate(p, size);
+		}
+
 		// non-assignable
 		Item& operator=(const Item&) = delete;
 
@@ -817,6 +804,14 @@ class Item : virtual public Thing {
 		// Returns the player that is holding this item in his inventory
 		const Player* getHoldingPlayer() const;
 
+		// Passes a change of this item's weight on to the container or player holding it
+		void updateParentWeight(int32_t diff);
+
+		// Marks the house this item lies in for the next save, or its map region as changed
+		void notifyHouseChange();
+		// the house this item lies in, not if it is carried or kept in a depot
+		House* getMapHouse() const;
+
 		WeaponType_t getWeaponType() const {
 			return items[id].weaponType;
 		}
@@ -1025,6 +1020,8 @@ class Item : virtual public Thing {
 		void setParent(Cylinder* cylinder) override {
 			parent = cylinder;
 		}
+		// the outermost item holding this one on the map, nullptr if it is carried or kept in a depot
+		const Item* getMapTopItem() const;
 		Cylinder* getTopParent();
 		const Cylinder* getTopParent() const;
 		Tile* getTile() override;
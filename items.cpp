@@ -5,8 +5,10 @@
 
 #include "items.h"
 
+#include "condition.h"
 #include "movement.h"
 #include "pugicast.h"
+#include "tools.h"
 #include "weapons.h"
 
 extern MoveEvents* g_moveEvents;
@@ -244,6 +246,194 @@ namespace {
 		return DIRECTION_NORTH;
 	}
 
+	constexpr OTB::Identifier ITEMS_CACHE_IDENTIFIER = {{'O', 'T', 'I', 'C'}};
+	constexpr uint32_t ITEMS_CACHE_VERSION = 1;
+	const std::filesystem::path ITEMS_CACHE_FILE = "data/items/items.cache";
+
+	std::optional<uint64_t> getItemsCacheKey() {
+		auto otb = readFileContents("data/items/items.otb");
+		auto xml = readFileContents("data/items/items.xml");
+		if (!otb || !xml) {
+			return std::nullopt;
+		}
+		return hashContents(*otb) ^ (hashContents(*xml) * 31);
+	}
+
+	// the cache holds the fields in this order, writing and reading go through the same list
+	template <typename ItemTypeRef, typename Field>
+	void forEachItemTypeField(ItemTypeRef& it, Field&& field) {
+		field(it.group);
+		field(it.type);
+		field(it.id);
+		field(it.clientId);
+		field(it.stackable);
+		field(it.isAnimation);
+
+		field(it.name);
+		field(it.article);
+		field(it.pluralName);
+		field(it.description);
+		field(it.runeSpellName);
+		field(it.vocationString);
+
+		field(it.abilities);
+		field(it.conditionDamage);
+
+		field(it.attackSpeed);
+		field(it.weight);
+		field(it.levelDoor);
+		field(it.decayTime);
+		field(it.wieldInfo);
+		field(it.minReqLevel);
+		field(it.minReqMagicLevel);
+		field(it.charges);
+		field(it.maxHitChance);
+		field(it.decayTo);
+		field(it.attack);
+		field(it.defense);
+		field(it.extraDefense);
+		field(it.armor);
+		field(it.rotateTo);
+		field(it.runeMagLevel);
+		field(it.runeLevel);
+		field(it.worth);
+
+		field(it.combatType);
+
+		field(it.transformToOnUse);
+		field(it.transformToFree);
+		field(it.destroyTo);
+		field(it.maxTextLen);
+		field(it.writeOnceItemId);
+		field(it.transformEquipTo);
+		field(it.transformDeEquipTo);
+		field(it.maxItems);
+		field(it.slotPosition);
+		field(it.speed);
+		field(it.wareId);
+
+		field(it.magicEffect);
+		field(it.bedPartnerDir);
+		field(it.weaponType);
+		field(it.ammoType);
+		field(it.shootType);
+		field(it.corpseType);
+		field(it.fluidSource);
+
+		field(it.floorChange);
+		field(it.alwaysOnTopOrder);
+		field(it.lightLevel);
+		field(it.lightColor);
+		field(it.shootRange);
+		field(it.hitChance);
+
+		field(it.storeItem);
+		field(it.forceUse);
+		field(it.forceSerialize);
+		field(it.hasHeight);
+		field(it.walkStack);
+		field(it.blockSolid);
+		field(it.blockPickupable);
+		field(it.blockProjectile);
+		field(it.blockPathFind);
+		field(it.allowPickupable);
+		field(it.showDuration);
+		field(it.showCharges);
+		field(it.showAttributes);
+		field(it.replaceable);
+		field(it.pickupable);
+		field(it.rotatable);
+		field(it.useable);
+		field(it.moveable);
+		field(it.alwaysOnTop);
+		field(it.canReadText);
+		field(it.canWriteText);
+		field(it.isVertical);
+		field(it.isHorizontal);
+		field(it.isHangable);
+		field(it.allowDistRead);
+		field(it.lookThrough);
+		field(it.stopTime);
+		field(it.showCount);
+	}
+
+	struct ItemTypeWriter {
+		PropWriteStream& stream;
+
+		void operator()(const std::string& value) {
+			stream.writeString(value);
+		}
+
+		void operator()(const std::unique_ptr<Abilities>& abilities) {
+			stream.write<uint8_t>(abilities != nullptr);
+			if (abilities) {
+				stream.write(*abilities);
+			}
+		}
+
+		void operator()(const std::unique_ptr<ConditionDamage>& condition) {
+			stream.write<uint8_t>(condition != nullptr);
+			if (condition) {
+				condition->serializeTemplate(stream);
+			}
+		}
+
+		template <typename T, size_t N>
+		void operator()(const T (&values)[N]) {
+			for (const T& value : values) {
+				(*this)(value);
+			}
+		}
+
+		template <typename T>
+		void operator()(const T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			stream.write(value);
+		}
+	};
+
+	struct ItemTypeReader {
+		PropStream& stream;
+		bool ok = true;
+
+		void operator()(std::string& value) {
+			auto [str, read] = stream.readString();
+			value = str;
+			ok = ok && read;
+		}
+
+		void operator()(std::unique_ptr<Abilities>& abilities) {
+			uint8_t present = 0;
+			ok = ok && stream.read(present);
+			if (ok && present != 0) {
+				abilities = std::make_unique<Abilities>();
+				ok = stream.read(*abilities);
+			}
+		}
+
+		void operator()(std::unique_ptr<ConditionDamage>& condition) {
+			uint8_t present = 0;
+			ok = ok && stream.read(present);
+			if (ok && present != 0) {
+				condition = ConditionDamage::unserializeTemplate(stream);
+				ok = condition != nullptr;
+			}
+		}
+
+		template <typename T, size_t N>
+		void operator()(T (&values)[N]) {
+			for (T& value : values) {
+				(*this)(value);
+			}
+		}
+
+		template <typename T>
+		void operator()(T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			ok = ok && stream.read(value);
+		}
+	};
+
 } // namespace
 
 Items::Items() {
@@ -278,7 +468,7 @@ constexpr auto OTBI = OTB::Identifier{{'O','T', 'B', 'I'}};
 bool Items::loadFromOtb(const std::string& file) {
 	OTB::Loader loader{file, OTBI};
 
-	auto& root = loader.parseTree();
+	OTB::Node root = loader.getRoot();
 
 	PropStream props;
 	if (loader.getProps(root, props)) {
@@ -326,7 +516,8 @@ bool Items::loadFromOtb(const std::string& file) {
 		return false;
 	}
 
-	for (auto& itemNode : root.children) {
+	OTB::Node itemNode;
+	while (loader.nextChild(root, itemNode)) {
 		PropStream stream;
 		if (!loader.getProps(itemNode, stream)) {
 			return false;
@@ -549,6 +740,133 @@ bool Items::loadFromXml() {
 	return true;
 }
 
+bool Items::loadFromCache() {
+	auto key = getItemsCacheKey();
+	if (!key) {
+		return false;
+	}
+
+	std::optional<std::string> contents = readFileContents(ITEMS_CACHE_FILE);
+	if (!contents) {
+		return false;
+	}
+
+	PropStream stream;
+	stream.init(contents->data(), contents->size());
+
+	OTB::Identifier identifier;
+	uint32_t version;
+	uint64_t cachedKey;
+	uint32_t itemCount;
+	if (!stream.read(identifier) || identifier != ITEMS_CACHE_IDENTIFIER || !stream.read(version) || version != ITEMS_CACHE_VERSION || !stream.read(cachedKey) || cachedKey != *key) {
+		return false;
+	}
+
+	if (!stream.read(majorVersion) || !stream.read(minorVersion) || !stream.read(buildNumber) || !stream.read(itemCount)) {
+		return false;
+	}
+
+	// a cache that does not read back completely is ignored, the files are parsed instead
+	ItemTypeReader reader{stream};
+	std::vector<ItemType> cachedItems(itemCount);
+	for (ItemType& itemType : cachedItems) {
+		forEachItemTypeField(itemType, reader);
+		if (!reader.ok) {
+			return false;
+		}
+	}
+
+	uint32_t count;
+	if (!stream.read(count)) {
+		return false;
+	}
+
+	std::vector<uint16_t> serverIds(count);
+	for (uint16_t& serverId : serverIds) {
+		if (!stream.read(serverId)) {
+			return false;
+		}
+	}
+
+	NameMap cachedNames;
+	if (!stream.read(count)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		auto [name, ok] = stream.readString();
+		uint16_t id;
+		if (!ok || !stream.read(id)) {
+			return false;
+		}
+		cachedNames.emplace(name, id);
+	}
+
+	CurrencyMap cachedCurrencies;
+	if (!stream.read(count)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		uint64_t worth;
+		uint16_t id;
+		if (!stream.read(worth) || !stream.read(id)) {
+			return false;
+		}
+		cachedCurrencies.emplace(worth, id);
+	}
+
+	items = std::move(cachedItems);
+	clientIdToServerIdMap.setServerIds(std::move(serverIds));
+	nameToItems = std::move(cachedNames);
+	currencyItems = std::move(cachedCurrencies);
+	buildInventoryList();
+	return true;
+}
+
+void Items::saveToCache() const {
+	auto key = getItemsCacheKey();
+	if (!key) {
+		return;
+	}
+
+	PropWriteStream stream;
+	stream.write(ITEMS_CACHE_IDENTIFIER);
+	stream.write(ITEMS_CACHE_VERSION);
+	stream.write(*key);
+	stream.write(majorVersion);
+	stream.write(minorVersion);
+	stream.write(buildNumber);
+
+	ItemTypeWriter writer{stream};
+	stream.write<uint32_t>(items.size());
+	for (const ItemType& itemType : items) {
+		forEachItemTypeField(itemType, writer);
+	}
+
+	const std::vector<uint16_t>& serverIds = clientIdToServerIdMap.getServerIds();
+	stream.write<uint32_t>(serverIds.size());
+	for (uint16_t serverId : serverIds) {
+		stream.write(serverId);
+	}
+
+	stream.write<uint32_t>(nameToItems.size());
+	for (const auto& [name, id] : nameToItems) {
+		stream.writeString(name);
+		stream.write(id);
+	}
+
+	stream.write<uint32_t>(currencyItems.size());
+	for (const auto& [worth, id] : currencyItems) {
+		stream.write(worth);
+		stream.write(id);
+	}
+
+	if (!replaceFileContents(ITEMS_CACHE_FILE, stream.getStream())) {
+		std::cout << "[Warning - Items::saveToCache] Could not write " << ITEMS_CACHE_FILE << '.' << std::endl;
+	}
+}
+
 void Items::buildInventoryList() {
 	inventory.reserve(items.size());
 	for (const auto& type: items) {
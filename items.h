@@ -192,6 +192,7 @@ struct Abilities {
 	bool regeneration = false;
 };
 
+// a field added here has to be added to the items cache too, see forEachItemTypeField in items.cpp
 class ItemType {
 	public:
 		ItemType() = default;
@@ -408,6 +409,10 @@ class Items {
 		bool loadFromXml();
 		void parseItemNode(const pugi::xml_node& itemNode, uint16_t id);
 
+		// items.otb and items.xml decoded into one file, only read while neither of them changed since it was written
+		bool loadFromCache();
+		void saveToCache() const;
+
 		void buildInventoryList();
 		const InventoryVector& getInventory() const {
 			return inventory;
@@ -449,6 +454,13 @@ class Items {
 				void clear() {
 					vec.clear();
 				}
+
+				const std::vector<uint16_t>& getServerIds() const {
+					return vec;
+				}
+				void setServerIds(std::vector<uint16_t> serverIds) {
+					vec = std::move(serverIds);
+				}
 			private:
 				std::vector<uint16_t> vec;
 		} clientIdToServerIdMap;
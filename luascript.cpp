@@ -17,6 +17,7 @@
 #include "housetile.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "iomap.h"
 #include "iomapserialize.h"
 #include "luavariant.h"
 #include "matrixarea.h"
@@ -253,6 +254,17 @@ namespace {
 		new (lua_newuserdata(L, sizeof(T))) T(std::move(value));
 	}
 
+	void pushSlabStats(lua_State* L, const SlabStats& stats) {
+		lua_createtable(L, 0, 7);
+		setField(L, "slabs", stats.slabs);
+		setField(L, "releasedSlabs", stats.releasedSlabs);
+		setField(L, "allocations", stats.allocations);
+		setField(L, "deallocations", stats.deallocations);
+		setField(L, "largeAllocations", stats.largeAllocations);
+		setField(L, "freeBytes", stats.freeBytes);
+		setField(L, "slabBytes", stats.slabs * SlabAllocator<Item>::SLAB_SIZE);
+	}
+
 } // namespace
 
 ScriptEnvironment::ScriptEnvironment() {
@@ -1166,7 +1178,7 @@ void LuaScriptInterface::registerFunctions() {
 	//saveServer()
 	lua_register(L, "saveServer", LuaScriptInterface::luaSaveServer);
 
-	//cleanMap()
+	//cleanMap([callback])
 	lua_register(L, "cleanMap", LuaScriptInterface::luaCleanMap);
 
 	//debugPrint(text)
@@ -2163,6 +2175,15 @@ void LuaScriptInterface::registerFunctions() {
 	registerEnumIn(L, "configKeys", ConfigManager::STAMINA_REGEN_MINUTE);
 	registerEnumIn(L, "configKeys", ConfigManager::STAMINA_REGEN_PREMIUM);
 	registerEnumIn(L, "configKeys", ConfigManager::MONSTER_OVERSPAWN);
+	registerEnumIn(L, "configKeys", ConfigManager::ASYNC_SERVER_SAVE);
+	registerEnumIn(L, "configKeys", ConfigManager::USE_WORLD_CACHE);
+	registerEnumIn(L, "configKeys", ConfigManager::PLAYER_SAVE_INTERVAL);
+	registerEnumIn(L, "configKeys", ConfigManager::DATABASE_WORKERS);
+	registerEnumIn(L, "configKeys", ConfigManager::LOGIN_CACHE_TIME);
+	registerEnumIn(L, "configKeys", ConfigManager::CLEAN_SKIP_VISIBLE_TILES);
+	registerEnumIn(L, "configKeys", ConfigManager::CLEAN_TILES_PER_SLICE);
+	registerEnumIn(L, "configKeys", ConfigManager::MAP_PAGING);
+	registerEnumIn(L, "configKeys", ConfigManager::MAP_REGION_IDLE_TIME);
 
 	// os
 	registerMethod(L, "os", "mtime", LuaScriptInterface::luaSystemTime);
@@ -2236,6 +2257,16 @@ void LuaScriptInterface::registerFunctions() {
 	registerMethod(L, "Game", "setAccountStorageValue", LuaScriptInterface::luaGameSetAccountStorageValue);
 	registerMethod(L, "Game", "saveAccountStorageValues", LuaScriptInterface::luaGameSaveAccountStorageValues);
 
+	registerMethod(L, "Game", "getPlayerSaveStats", LuaScriptInterface::luaGameGetPlayerSaveStats);
+	registerMethod(L, "Game", "clearLoginCache", LuaScriptInterface::luaGameClearLoginCache);
+	registerMethod(L, "Game", "addAccountBan", LuaScriptInterface::luaGameAddAccountBan);
+	registerMethod(L, "Game", "removeAccountBan", LuaScriptInterface::luaGameRemoveAccountBan);
+	registerMethod(L, "Game", "addIpBan", LuaScriptInterface::luaGameAddIpBan);
+	registerMethod(L, "Game", "removeIpBan", LuaScriptInterface::luaGameRemoveIpBan);
+	registerMethod(L, "Game", "setAccountPassword", LuaScriptInterface::luaGameSetAccountPassword);
+	registerMethod(L, "Game", "getSlabStats", LuaScriptInterface::luaGameGetSlabStats);
+	registerMethod(L, "Game", "getMapPagingStats", LuaScriptInterface::luaGameGetMapPagingStats);
+
 	// Variant
 	registerClass(L, "Variant", "", LuaScriptInterface::luaVariantCreate);
 
@@ -3813,7 +3844,47 @@ int LuaScriptInterface::luaSaveServer(lua_State* L) {
 }
 
 int LuaScriptInterface::luaCleanMap(lua_State* L) {
-	lua_pushnumber(L, g_game.map.clean());
+	//cleanMap([callback])
+	if (!lua_isfunction(L, 1)) {
+		lua_pushnumber(L, g_game.map.clean());
+		return 1;
+	}
+
+	// with a callback the map is cleaned in slices and the callback gets the item and tile counts
+	if (g_game.isCleaningMap()) {
+		lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	// the callback is called on the global state, the caller may be running on a thread of it
+	lua_State* globalState = g_luaEnvironment.getLuaState();
+	lua_settop(L, 1);
+	if (L != globalState) {
+		lua_xmove(L, globalState, 1);
+	}
+	int32_t ref = luaL_ref(globalState, LUA_REGISTRYINDEX);
+	auto scriptId = lua::getScriptEnv()->getScriptId();
+	g_game.startMapClean([ref, scriptId](uint32_t items, size_t tiles) {
+		lua_State* L = g_luaEnvironment.getLuaState();
+		if (!L) {
+			return;
+		}
+
+		if (!lua::reserveScriptEnv()) {
+			luaL_unref(L, LUA_REGISTRYINDEX, ref);
+			return;
+		}
+
+		lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+		lua_pushnumber(L, items);
+		lua_pushnumber(L, tiles);
+		auto env = lua::getScriptEnv();
+		env->setScriptId(scriptId, &g_luaEnvironment);
+		g_luaEnvironment.callFunction(2);
+
+		luaL_unref(L, LUA_REGISTRYINDEX, ref);
+	});
+	lua::pushBoolean(L, true);
 	return 1;
 }
 
@@ -3979,6 +4050,7 @@ const luaL_Reg LuaScriptInterface::luaDatabaseTable[] = {
 	{"escapeBlob", LuaScriptInterface::luaDatabaseEscapeBlob},
 	{"lastInsertId", LuaScriptInterface::luaDatabaseLastInsertId},
 	{"tableExists", LuaScriptInterface::luaDatabaseTableExists},
+	{"getTaskStats", LuaScriptInterface::luaDatabaseGetTaskStats},
 	{nullptr, nullptr}
 };
 
@@ -4012,7 +4084,7 @@ int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L) {
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(lua::getString(L, -1), callback);
+	g_databaseTasks.addTask(lua::getString(L, -1), callback, false, DATABASE_TASK_SCRIPTS);
 	return 0;
 }
 
@@ -4054,7 +4126,7 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L) {
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(lua::getString(L, -1), callback, true);
+	g_databaseTasks.addTask(lua::getString(L, -1), callback, true, DATABASE_TASK_SCRIPTS);
 	return 0;
 }
 
@@ -4079,6 +4151,19 @@ int LuaScriptInterface::luaDatabaseTableExists(lua_State* L) {
 	return 1;
 }
 
+int LuaScriptInterface::luaDatabaseGetTaskStats(lua_State* L) {
+	// db.getTaskStats()
+	DatabaseTaskStats stats = g_databaseTasks.getStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "queued", stats.queued);
+	setField(L, "executed", stats.executed);
+	setField(L, "batched", stats.batched);
+	setField(L, "averageWait", stats.executed != 0 ? stats.totalWait / static_cast<double>(stats.executed) : 0);
+	setField(L, "averageRun", stats.executed != 0 ? stats.totalRun / static_cast<double>(stats.executed) : 0);
+	setField(L, "maxRun", stats.maxRun);
+	return 1;
+}
+
 const luaL_Reg LuaScriptInterface::luaResultTable[] = {
 	{"getNumber", LuaScriptInterface::luaResultGetNumber},
 	{"getString", LuaScriptInterface::luaResultGetString},
@@ -4778,6 +4863,92 @@ int LuaScriptInterface::luaGameGetClientVersion(lua_State* L) {
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetPlayerSaveStats(lua_State* L) {
+	// Game.getPlayerSaveStats()
+	lua_createtable(L, 0, 2);
+	setField(L, "backlog", g_game.getPlayerSaveBacklog());
+	setField(L, "delay", g_game.getPlayerSaveDelay());
+	return 1;
+}
+
+int LuaScriptInterface::luaGameClearLoginCache(lua_State* L) {
+	// Game.clearLoginCache([accountId])
+	// to be called after scripts write the accounts, players or ban tables without the Game functions that clear it
+	uint32_t accountId = lua::getNumber<uint32_t>(L, 1, 0);
+	IOLoginData::clearAccountLoginCache(accountId);
+	IOBan::clearBanCache(accountId);
+	return 0;
+}
+
+int LuaScriptInterface::luaGameAddAccountBan(lua_State* L) {
+	// Game.addAccountBan(accountId, reason, expiresAt[, bannedBy = 0])
+	uint32_t accountId = lua::getNumber<uint32_t>(L, 1);
+	std::string reason = lua::getString(L, 2);
+	time_t expiresAt = lua::getNumber<time_t>(L, 3);
+	uint32_t bannedBy = lua::getNumber<uint32_t>(L, 4, 0);
+	lua::pushBoolean(L, IOBan::addAccountBan(accountId, reason, expiresAt, bannedBy));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameRemoveAccountBan(lua_State* L) {
+	// Game.removeAccountBan(accountId)
+	lua::pushBoolean(L, IOBan::removeAccountBan(lua::getNumber<uint32_t>(L, 1)));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameAddIpBan(lua_State* L) {
+	// Game.addIpBan(ip, reason, expiresAt[, bannedBy = 0])
+	std::string ip = lua::getString(L, 1);
+	std::string reason = lua::getString(L, 2);
+	time_t expiresAt = lua::getNumber<time_t>(L, 3);
+	uint32_t bannedBy = lua::getNumber<uint32_t>(L, 4, 0);
+	lua::pushBoolean(L, IOBan::addIpBan(ip, reason, expiresAt, bannedBy));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameRemoveIpBan(lua_State* L) {
+	// Game.removeIpBan(ip)
+	lua::pushBoolean(L, IOBan::removeIpBan(lua::getString(L, 1)));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameSetAccountPassword(lua_State* L) {
+	// Game.setAccountPassword(accountId, password)
+	uint32_t accountId = lua::getNumber<uint32_t>(L, 1);
+	std::string password = lua::getString(L, 2);
+	lua::pushBoolean(L, IOLoginData::setAccountPassword(accountId, password));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetSlabStats(lua_State* L) {
+	// Game.getSlabStats()
+	lua_createtable(L, 0, 2);
+	pushSlabStats(L, SlabAllocator<Item>::getStats());
+	lua_setfield(L, -2, "items");
+	pushSlabStats(L, SlabAllocator<Tile>::getStats());
+	lua_setfield(L, -2, "tiles");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetMapPagingStats(lua_State* L) {
+	// Game.getMapPagingStats()
+	const MapPager* pager = g_game.map.getPager();
+	if (!pager) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	MapPagerStats stats = pager->getStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "regions", stats.regions);
+	setField(L, "loadedRegions", stats.loadedRegions);
+	setField(L, "pinnedRegions", stats.pinnedRegions);
+	setField(L, "changedRegions", stats.changedRegions);
+	setField(L, "loads", stats.loads);
+	setField(L, "unloads", stats.unloads);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameReload(lua_State* L) {
 	// Game.reload(reloadType)
 	ReloadTypes_t reloadType = lua::getNumber<ReloadTypes_t>(L, 1);
@@ -5046,9 +5217,8 @@ int LuaScriptInterface::luaTileRemove(lua_State* L) {
 		return 1;
 	}
 
-	if (g_game.isTileInCleanList(tile)) {
-		g_game.removeTileToClean(tile);
-	}
+	// also drops the tile from a running clean
+	g_game.removeTileToClean(tile);
 
 	g_game.map.removeTile(tile->getPosition());
 	lua::pushBoolean(L, true);
@@ -5491,7 +5661,7 @@ int LuaScriptInterface::luaTileGetCreatures(lua_State* L) {
 		return 1;
 	}
 
-	CreatureVector* creatureVector = tile->getCreatures();
+	TileCreatureVector* creatureVector = tile->getCreatures();
 	if (!creatureVector) {
 		lua_pushnil(L);
 		return 1;
@@ -6383,6 +6553,7 @@ int LuaScriptInterface::luaItemSetActionId(lua_State* L) {
 	Item* item = lua::getUserdata<Item>(L, 1);
 	if (item) {
 		item->setActionId(actionId);
+		item->notifyHouseChange();
 		lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6590,10 +6761,14 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L) {
 			return 1;
 		}
 
+		const int32_t oldWeight = item->getWeight();
 		item->setIntAttr(attribute, lua::getNumber<int32_t>(L, 3));
+		item->updateParentWeight(static_cast<int32_t>(item->getWeight()) - oldWeight);
+		item->notifyHouseChange();
 		lua::pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, lua::getString(L, 3));
+		item->notifyHouseChange();
 		lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6620,7 +6795,10 @@ int LuaScriptInterface::luaItemRemoveAttribute(lua_State* L) {
 
 	bool ret = attribute != ITEM_ATTRIBUTE_UNIQUEID;
 	if (ret) {
+		const int32_t oldWeight = item->getWeight();
 		item->removeAttribute(attribute);
+		item->updateParentWeight(static_cast<int32_t>(item->getWeight()) - oldWeight);
+		item->notifyHouseChange();
 	} else {
 		reportErrorFunc(L, "Attempt to erase protected key \"uid\"");
 	}
@@ -6690,6 +6868,7 @@ int LuaScriptInterface::luaItemSetCustomAttribute(lua_State* L) {
 	}
 
 	item->setCustomAttribute(key, val);
+	item->notifyHouseChange();
 	lua::pushBoolean(L, true);
 	return 1;
 }
@@ -6708,7 +6887,9 @@ int LuaScriptInterface::luaItemRemoveCustomAttribute(lua_State* L) {
 		lua::pushBoolean(L, item->removeCustomAttribute(lua::getString(L, 2)));
 	} else {
 		lua_pushnil(L);
+		return 1;
 	}
+	item->notifyHouseChange();
 	return 1;
 }
 
@@ -169,7 +169,7 @@ class LuaScriptInterface {
 		static const luaL_Reg luaBitReg[7];
 #endif
 		static const luaL_Reg luaConfigManagerTable[4];
-		static const luaL_Reg luaDatabaseTable[9];
+		static const luaL_Reg luaDatabaseTable[10];
 		static const luaL_Reg luaResultTable[6];
 
 	protected:
@@ -251,6 +251,7 @@ class LuaScriptInterface {
 		static int luaDatabaseEscapeBlob(lua_State* L);
 		static int luaDatabaseLastInsertId(lua_State* L);
 		static int luaDatabaseTableExists(lua_State* L);
+		static int luaDatabaseGetTaskStats(lua_State* L);
 
 		static int luaResultGetNumber(lua_State* L);
 		static int luaResultGetString(lua_State* L);
@@ -331,6 +332,15 @@ class LuaScriptInterface {
 		static int luaGameGetAccountStorageValue(lua_State* L);
 		static int luaGameSetAccountStorageValue(lua_State* L);
 		static int luaGameSaveAccountStorageValues(lua_State* L);
+		static int luaGameGetPlayerSaveStats(lua_State* L);
+		static int luaGameGetSlabStats(lua_State* L);
+		static int luaGameGetMapPagingStats(lua_State* L);
+		static int luaGameClearLoginCache(lua_State* L);
+		static int luaGameAddAccountBan(lua_State* L);
+		static int luaGameRemoveAccountBan(lua_State* L);
+		static int luaGameAddIpBan(lua_State* L);
+		static int luaGameRemoveIpBan(lua_State* L);
+		static int luaGameSetAccountPassword(lua_State* L);
 
 		// Variant
 		static int luaVariantCreate(lua_State* L);
@@ -15,19 +15,27 @@
 
 extern Game g_game;
 
+Map::Map() = default;
+Map::~Map() = default;
+
 bool Map::loadMap(const std::string& identifier, bool loadHouses, bool isCalledByLua) {
 	IOMap loader;
-	if (!loader.loadMap(this, identifier)) {
+	if (!loader.decodeMap(identifier)) {
 		std::cout << "[Fatal - Map::loadMap] " << loader.getLastErrorString() << std::endl;
 		return false;
 	}
+	return loadMap(loader, loadHouses, isCalledByLua);
+}
+
+bool Map::loadMap(IOMap& loader, bool loadHouses, bool isCalledByLua) {
+	loader.commitMap(this);
 
-	if (!IOMap::loadSpawns(this, isCalledByLua)) {
+	if (!loader.loadSpawns(this, isCalledByLua)) {
 		std::cout << "[Warning - Map::loadMap] Failed to load spawn data." << std::endl;
 	}
 
 	if (loadHouses && !isCalledByLua) {
-		if (!IOMap::loadHouses(this)) {
+		if (!loader.loadHouses(this)) {
 			std::cout << "[Warning - Map::loadMap] Failed to load house data." << std::endl;
 		}
 
@@ -66,15 +74,34 @@ Tile* Map::getTile(uint16_t x, uint16_t y, uint8_t z) const {
 	}
 
 	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
-	if (!leaf) {
-		return nullptr;
+	if (leaf) {
+		if (const Floor* floor = leaf->getFloor(z)) {
+			if (Tile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK]) {
+				if (pager) {
+					pager->touchRegion(x, y, z);
+				}
+				return tile;
+			}
+		}
 	}
 
-	const Floor* floor = leaf->getFloor(z);
-	if (!floor) {
-		return nullptr;
+	// a paged region is decoded the first time one of its tiles is asked for
+	if (pager && pager->loadRegion(x, y, z)) {
+		return getTile(x, y, z);
+	}
+	return nullptr;
+}
+
+void Map::setRegionChanged(const Position& pos) {
+	if (pager) {
+		pager->setRegionChanged(pos.x, pos.y, pos.z);
+	}
+}
+
+void Map::unloadIdleRegions(int64_t idleTime) {
+	if (pager) {
+		pager->unloadIdleRegions(idleTime);
 	}
-	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
 }
 
 void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile) {
@@ -154,7 +181,7 @@ void Map::removeTile(uint16_t x, uint16_t y, uint8_t z) {
 
 	Tile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
 	if (tile) {
-		if (const CreatureVector* creatures = tile->getCreatures()) {
+		if (const TileCreatureVector* creatures = tile->getCreatures()) {
 			for (int32_t i = creatures->size(); --i >= 0;) {
 				if (Player* player = (*creatures)[i]->getPlayer()) {
 					g_game.internalTeleport(player, player->getTown()->getTemplePosition(), false, FLAG_NOLIMIT);
@@ -383,6 +410,41 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 	}
 }
 
+void Map::getSpectatorRangeZ(const Position& centerPos, bool multifloor, int32_t& minRangeZ, int32_t& maxRangeZ) {
+	if (multifloor) {
+		if (centerPos.z > 7) {
+			//underground (8->15)
+			minRangeZ = std::max(centerPos.getZ() - 2, 0);
+			maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
+		} else if (centerPos.z == 6) {
+			minRangeZ = 0;
+			maxRangeZ = 8;
+		} else if (centerPos.z == 7) {
+			minRangeZ = 0;
+			maxRangeZ = 9;
+		} else {
+			minRangeZ = 0;
+			maxRangeZ = 7;
+		}
+	} else {
+		minRangeZ = centerPos.z;
+		maxRangeZ = centerPos.z;
+	}
+}
+
+bool Map::isInSpectatorRange(const Position& centerPos, const Position& pos, bool multifloor) {
+	int32_t minRangeZ;
+	int32_t maxRangeZ;
+	getSpectatorRangeZ(centerPos, multifloor, minRangeZ, maxRangeZ);
+	if (minRangeZ > pos.z || maxRangeZ < pos.z) {
+		return false;
+	}
+
+	int16_t offsetZ = centerPos.getOffsetZ(pos);
+	return (centerPos.x - maxViewportX + offsetZ) <= pos.x && (centerPos.x + maxViewportX + offsetZ) >= pos.x
+		&& (centerPos.y - maxViewportY + offsetZ) <= pos.y && (centerPos.y + maxViewportY + offsetZ) >= pos.y;
+}
+
 void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/) {
 	if (centerPos.z >= MAP_MAX_LAYERS) {
 		return;
@@ -439,26 +501,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	if (!foundCache) {
 		int32_t minRangeZ;
 		int32_t maxRangeZ;
-
-		if (multifloor) {
-			if (centerPos.z > 7) {
-				//underground (8->15)
-				minRangeZ = std::max(centerPos.getZ() - 2, 0);
-				maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == 6) {
-				minRangeZ = 0;
-				maxRangeZ = 8;
-			} else if (centerPos.z == 7) {
-				minRangeZ = 0;
-				maxRangeZ = 9;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = 7;
-			}
-		} else {
-			minRangeZ = centerPos.z;
-			maxRangeZ = centerPos.z;
-		}
+		getSpectatorRangeZ(centerPos, multifloor, minRangeZ, maxRangeZ);
 
 		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
 
@@ -11,6 +11,8 @@
 #include "town.h"
 
 class Creature;
+class IOMap;
+class MapPager;
 
 static constexpr int32_t MAP_MAX_LAYERS = 16;
 static constexpr uint16_t MAP_NORMALWALKCOST = 10;
@@ -140,6 +142,7 @@ class QTreeLeafNode final : public QTreeNode {
 		CreatureVector player_list;
 
 		friend class Map;
+		friend class MapPager;
 		friend class QTreeNode;
 };
 
@@ -157,6 +160,9 @@ class Map {
 
 		static constexpr int16_t nodeReserveSize = static_cast<int16_t>((maxViewportX * maxViewportY * 3) / 2);
 
+		Map();
+		~Map();
+
 		uint32_t clean() const;
 
 		/**
@@ -164,6 +170,8 @@ class Map {
 		  * \returns true if the map was loaded successfully
 		  */
 		bool loadMap(const std::string& identifier, bool loadHouses, bool isCalledByLua = true);
+		// commits a map decoded ahead of time
+		bool loadMap(IOMap& loader, bool loadHouses, bool isCalledByLua = true);
 
 		/**
 		  * Save a map.
@@ -211,6 +219,11 @@ class Map {
 		                   int32_t minRangeX = 0, int32_t maxRangeX = 0,
 		                   int32_t minRangeY = 0, int32_t maxRangeY = 0);
 
+		/**
+		  * Checks if pos would be included by getSpectators around centerPos with the default viewport range
+		  */
+		static bool isInSpectatorRange(const Position& centerPos, const Position& pos, bool multifloor);
+
 		void clearSpectatorCache();
 		void clearPlayersSpectatorCache();
 
@@ -255,6 +268,13 @@ class Map {
 			return QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, x, y);
 		}
 
+		// with mapPaging, a region whose items changed is never dropped
+		void setRegionChanged(const Position& pos);
+		void unloadIdleRegions(int64_t idleTime);
+		const MapPager* getPager() const {
+			return pager.get();
+		}
+
 		Spawns spawns;
 		Towns towns;
 		Houses houses;
@@ -264,6 +284,7 @@ class Map {
 		SpectatorCache playersSpectatorCache;
 
 		QTreeNode root;
+		std::unique_ptr<MapPager> pager;
 
 		std::filesystem::path spawnfile;
 		std::filesystem::path housefile;
@@ -271,6 +292,8 @@ class Map {
 		uint32_t width = 0;
 		uint32_t height = 0;
 
+		static void getSpectatorRangeZ(const Position& centerPos, bool multifloor, int32_t& minRangeZ, int32_t& maxRangeZ);
+
 		// Actually scans the map for spectators
 		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
 
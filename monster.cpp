@@ -1149,7 +1149,7 @@ bool Monster::pushCreature(Creature* creature) {
 void Monster::pushCreatures(Tile* tile) {
 	//We can not use iterators here since we can push a creature to another tile
 	//which will invalidate the iterator.
-	if (CreatureVector* creatures = tile->getCreatures()) {
+	if (TileCreatureVector* creatures = tile->getCreatures()) {
 		uint32_t removeCount = 0;
 		Monster* lastPushedMonster = nullptr;
 
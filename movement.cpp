@@ -610,7 +610,7 @@ uint32_t MoveEvent::StepOutField(Creature*, Item*, const Position&) {
 uint32_t MoveEvent::AddItemField(Item* item, Item*, const Position&) {
 	if (MagicField* field = item->getMagicField()) {
 		Tile* tile = item->getTile();
-		if (CreatureVector* creatures = tile->getCreatures()) {
+		if (TileCreatureVector* creatures = tile->getCreatures()) {
 			for (Creature* creature : *creatures) {
 				field->onStepInField(creature);
 			}
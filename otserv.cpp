@@ -9,6 +9,7 @@
 #include "databasemanager.h"
 #include "databasetasks.h"
 #include "game.h"
+#include "iomap.h"
 #include "iomarket.h"
 #include "monsters.h"
 #include "outfit.h"
@@ -22,6 +23,7 @@
 #include "server.h"
 
 #include <fstream>
+#include <future>
 
 #if __has_include("gitmetadata.h")
 #include "gitmetadata.h"
@@ -47,6 +49,41 @@ namespace {
 		g_loaderSignal.notify_all();
 	}
 
+	// one part of the startup, returns an error message if it failed
+	struct StartupTask {
+		std::string name;
+		std::function<std::optional<std::string>()> run;
+	};
+
+	// the tasks of a stage do not depend on each other, the first one runs on the dispatcher and the others on their own threads
+	bool runStartupStage(std::vector<StartupTask> tasks) {
+		auto runTask = [](StartupTask& task) {
+			int64_t start = OTSYS_TIME();
+			std::optional<std::string> error = task.run();
+			std::cout << fmt::format("> {:s} loaded in {:.3f} seconds.", task.name, (OTSYS_TIME() - start) / 1000.) << std::endl;
+			return error;
+		};
+
+		std::vector<std::future<std::optional<std::string>>> futures;
+		for (size_t i = 1; i < tasks.size(); ++i) {
+			futures.push_back(std::async(std::launch::async, runTask, std::ref(tasks[i])));
+		}
+
+		std::vector<std::optional<std::string>> errors;
+		errors.push_back(runTask(tasks.front()));
+		for (auto& future : futures) {
+			errors.push_back(future.get());
+		}
+
+		for (const auto& error : errors) {
+			if (error) {
+				startupErrorMessage(*error);
+				return false;
+			}
+		}
+		return true;
+	}
+
 	void mainLoader(ServiceManager* services) {
 		//dispatcher thread
 		g_game.setGameState(GAME_STATE_STARTUP);
@@ -124,62 +161,96 @@ namespace {
 			startupErrorMessage("The database you have specified in config.lua is empty, please import the schema.sql to your database.");
 			return;
 		}
-		g_databaseTasks.start();
-
-		DatabaseManager::updateDatabase();
-
-		if (getBoolean(ConfigManager::OPTIMIZE_DATABASE) && !DatabaseManager::optimizeTables()) {
-			std::cout << "> No tables were optimized." << std::endl;
-		}
-
-		//load vocations
-		std::cout << ">> Loading vocations" << std::endl;
-		if (!g_vocations.loadFromXml()) {
-			startupErrorMessage("Unable to load vocations!");
-			return;
-		}
-
-		// load item data
-		std::cout << ">> Loading items... ";
-		if (!Item::items.loadFromOtb("data/items/items.otb")) {
-			startupErrorMessage("Unable to load items (OTB)!");
-			return;
-		}
-
-		std::cout << fmt::format("OTB v{:d}.{:d}.{:d}", Item::items.majorVersion, Item::items.minorVersion, Item::items.buildNumber) << std::endl;
 
-		if (!Item::items.loadFromXml()) {
-			startupErrorMessage("Unable to load items (XML)!");
+		if (!g_databaseTasks.start()) {
+			startupErrorMessage("Failed to connect the database workers.");
 			return;
 		}
 
-		std::cout << ">> Loading script systems" << std::endl;
-		if (!ScriptingManager::getInstance().loadScriptSystems()) {
-			startupErrorMessage("Failed to load script systems");
-			return;
-		}
+		DatabaseManager::updateDatabase();
 
-		std::cout << ">> Loading lua scripts" << std::endl;
-		if (!g_scripts->loadScripts("scripts", false, false)) {
-			startupErrorMessage("Failed to load lua scripts");
-			return;
+		if (getBoolean(ConfigManager::OPTIMIZE_DATABASE) && !DatabaseManager::optimizeTables()) {
+			std::cout << "> No tables were optimized." << std::endl;
 		}
 
-		std::cout << ">> Loading monsters" << std::endl;
-		if (!g_monsters.loadFromXml()) {
-			startupErrorMessage("Unable to load monsters!");
+		// plain data files, the scripts need vocations and items
+		std::cout << ">> Loading vocations, items and outfits" << std::endl;
+		if (!runStartupStage({
+			{"Vocations", []() -> std::optional<std::string> {
+				if (!g_vocations.loadFromXml()) {
+					return "Unable to load vocations!";
+				}
+				return std::nullopt;
+			}},
+			{"Items", []() -> std::optional<std::string> {
+				const bool useCache = getBoolean(ConfigManager::USE_WORLD_CACHE);
+				if (useCache && Item::items.loadFromCache()) {
+					std::cout << "> Items loaded from the world cache" << std::endl;
+				} else {
+					if (!Item::items.loadFromOtb("data/items/items.otb")) {
+						return "Unable to load items (OTB)!";
+					}
+
+					if (!Item::items.loadFromXml()) {
+						return "Unable to load items (XML)!";
+					}
+
+					if (useCache) {
+						Item::items.saveToCache();
+					}
+				}
+
+				std::cout << fmt::format("> Items OTB v{:d}.{:d}.{:d}", Item::items.majorVersion, Item::items.minorVersion, Item::items.buildNumber) << std::endl;
+				return std::nullopt;
+			}},
+			{"Outfits", []() -> std::optional<std::string> {
+				if (!Outfits::getInstance().loadFromXml()) {
+					return "Unable to load outfits!";
+				}
+				return std::nullopt;
+			}},
+		})) {
 			return;
 		}
 
-		std::cout << ">> Loading lua monsters" << std::endl;
-		if (!g_scripts->loadScripts("monster", false, false)) {
-			startupErrorMessage("Failed to load lua monsters");
+		// lua is single threaded, and weapon scripts may change item types the map items are created from
+		std::cout << ">> Loading script systems and lua scripts" << std::endl;
+		if (!runStartupStage({
+			{"Scripts", []() -> std::optional<std::string> {
+				if (!ScriptingManager::getInstance().loadScriptSystems()) {
+					return "Failed to load script systems";
+				}
+
+				if (!g_scripts->loadScripts("scripts", false, false)) {
+					return "Failed to load lua scripts";
+				}
+				return std::nullopt;
+			}},
+		})) {
 			return;
 		}
 
-		std::cout << ">> Loading outfits" << std::endl;
-		if (!Outfits::getInstance().loadFromXml()) {
-			startupErrorMessage("Unable to load outfits!");
+		// the map file is decoded while the monsters load, it is put into the game once both are done
+		IOMap mapLoader;
+		std::cout << ">> Loading monsters and decoding map" << std::endl;
+		if (!runStartupStage({
+			{"Monsters", []() -> std::optional<std::string> {
+				if (!g_monsters.loadFromXml()) {
+					return "Unable to load monsters!";
+				}
+
+				if (!g_scripts->loadScripts("monster", false, false)) {
+					return "Failed to load lua monsters";
+				}
+				return std::nullopt;
+			}},
+			{"Map", [&mapLoader]() -> std::optional<std::string> {
+				if (!mapLoader.decodeMap("data/world/" + getString(ConfigManager::MAP_NAME) + ".otbm", getBoolean(ConfigManager::MAP_PAGING), true)) {
+					return "Failed to load map: " + mapLoader.getLastErrorString();
+				}
+				return std::nullopt;
+			}},
+		})) {
 			return;
 		}
 
@@ -199,7 +270,7 @@ namespace {
 		std::cout << boost::algorithm::to_upper_copy(worldType) << std::endl;
 
 		std::cout << ">> Loading map" << std::endl;
-		if (!g_game.loadMainMap(getString(ConfigManager::MAP_NAME))) {
+		if (!g_game.loadMainMap(mapLoader)) {
 			startupErrorMessage("Failed to load map");
 			return;
 		}
@@ -234,8 +305,10 @@ namespace {
 
 		g_game.map.houses.payHouses(rentPeriod);
 
+		std::cout << ">> Loading market" << std::endl;
+		IOMarket::getInstance().load();
+
 		IOMarket::checkExpiredOffers();
-		IOMarket::getInstance().updateStatistics();
 
 		std::cout << ">> Loaded all modules, server starting up..." << std::endl;
 
@@ -397,21 +397,27 @@ uint16_t Player::getClientIcons() const {
 }
 
 void Player::updateInventoryWeight() {
-	if (hasFlag(PlayerFlag_HasInfiniteCapacity)) {
-		return;
-	}
+	inventoryWeight = computeInventoryWeight();
+}
 
-	inventoryWeight = 0;
+void Player::addInventoryWeight(int32_t diff) {
+	assert(diff >= 0 || inventoryWeight >= static_cast<uint32_t>(-diff));
+	inventoryWeight += diff;
+}
+
+uint32_t Player::computeInventoryWeight() const {
+	uint32_t weight = 0;
 	for (int i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; ++i) {
 		const Item* item = inventory[i];
 		if (item) {
-			inventoryWeight += item->getWeight();
+			weight += item->getWeight();
 		}
 	}
 
 	if (StoreInbox* storeInbox = getStoreInbox()) {
-		inventoryWeight += storeInbox->getWeight();
+		weight += storeInbox->getWeight();
 	}
+	return weight;
 }
 
 void Player::addSkillAdvance(skills_t skill, uint64_t count) {
@@ -629,6 +635,49 @@ void Player::setStorageValue(uint32_t key, std::optional<int32_t> value, bool is
 	}
 
 	Creature::setStorageValue(key, value, isSpawn);
+
+	if (g_game.quests.isQuestStorageKey(key)) {
+		questLogRevision = 0;
+	}
+}
+
+void Player::updateQuestLogCache() {
+	const uint32_t revision = g_game.quests.getRevision();
+	if (questLogRevision == revision) {
+		return;
+	}
+
+	startedQuests.clear();
+	startedMissionsCount.clear();
+	for (const Quest& quest : g_game.quests.getQuests()) {
+		if (quest.isStarted(this)) {
+			startedQuests.push_back(&quest);
+		}
+	}
+	questLogRevision = revision;
+}
+
+const std::vector<const Quest*>& Player::getStartedQuests() {
+	updateQuestLogCache();
+	return startedQuests;
+}
+
+uint16_t Player::getStartedMissionsCount(const Quest& quest) {
+	updateQuestLogCache();
+
+	auto it = startedMissionsCount.find(quest.getID());
+	if (it != startedMissionsCount.end()) {
+		return it->second;
+	}
+
+	uint16_t count = 0;
+	for (const Mission& mission : quest.getMissions()) {
+		if (mission.isStarted(this)) {
+			++count;
+		}
+	}
+	startedMissionsCount.emplace(quest.getID(), count);
+	return count;
 }
 
 bool Player::canSee(const Position& pos) const {
@@ -734,10 +783,18 @@ Inbox_ptr Player::getInbox() {
 		inbox = std::make_shared<Inbox>(ITEM_INBOX);
 	}
 
+	if (DBResult_ptr result = std::move(pendingInboxItems)) {
+		IOLoginData::loadInboxItems(this, result);
+	}
+
 	return inbox;
 }
 
 DepotChest_ptr Player::getDepotChest(uint32_t depotId, bool autoCreate) {
+	if (DBResult_ptr result = std::move(pendingDepotItems)) {
+		IOLoginData::loadDepotItems(this, result);
+	}
+
 	auto it = depotChests.find(depotId);
 	if (it != depotChests.end()) {
 		return it->second;
@@ -1626,6 +1683,7 @@ void Player::addExperience(Creature* source, uint64_t exp, bool sendText/* = fal
 
 		g_game.changeSpeed(this, 0);
 		g_game.addCreatureHealth(this);
+		g_game.requestPlayerSave(this);
 
 		const uint32_t protectionLevel = static_cast<uint32_t>(getNumber(ConfigManager::PROTECTION_LEVEL));
 		if (prevLevel < protectionLevel && level >= protectionLevel) {
@@ -2649,6 +2707,8 @@ void Player::addThing(int32_t index, Thing* thing) {
 
 	item->setParent(this);
 	inventory[index] = item;
+	addInventoryWeight(item->getWeight());
+	addItemTypeCount(item);
 
 	//send to client
 	sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2665,8 +2725,12 @@ void Player::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	const int32_t oldWeight = item->getWeight();
+	updateItemTypeCount(item->getID(), -static_cast<int32_t>(item->getItemCount()));
 	item->setID(itemId);
 	item->setSubType(count);
+	updateItemTypeCount(item->getID(), item->getItemCount());
+	addInventoryWeight(-oldWeight + item->getWeight());
 
 	//send to client
 	sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2698,7 +2762,10 @@ void Player::replaceThing(uint32_t index, Thing* thing) {
 
 	item->setParent(this);
 
+	removeItemTypeCount(oldItem);
 	inventory[index] = item;
+	addInventoryWeight(-static_cast<int32_t>(oldItem->getWeight()) + item->getWeight());
+	addItemTypeCount(item);
 }
 
 void Player::removeThing(Thing* thing, uint32_t count) {
@@ -2720,11 +2787,16 @@ void Player::removeThing(Thing* thing, uint32_t count) {
 			//event methods
 			onRemoveInventoryItem(item);
 
+			addInventoryWeight(-static_cast<int32_t>(item->getWeight()));
+			removeItemTypeCount(item);
 			item->setParent(nullptr);
 			inventory[index] = nullptr;
 		} else {
 			uint8_t newCount = static_cast<uint8_t>(std::max<int32_t>(0, item->getItemCount() - count));
+			updateItemTypeCount(item->getID(), static_cast<int32_t>(newCount) - item->getItemCount());
+			const int32_t oldWeight = item->getWeight();
 			item->setItemCount(newCount);
+			addInventoryWeight(-oldWeight + item->getWeight());
 
 			//send change to client
 			sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2739,6 +2811,8 @@ void Player::removeThing(Thing* thing, uint32_t count) {
 		//event methods
 		onRemoveInventoryItem(item);
 
+		addInventoryWeight(-static_cast<int32_t>(item->getWeight()));
+		removeItemTypeCount(item);
 		item->setParent(nullptr);
 		inventory[index] = nullptr;
 	}
@@ -2762,6 +2836,18 @@ size_t Player::getLastIndex() const {
 }
 
 uint32_t Player::getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const {
+	assert(checkItemTypeIndex());
+
+	if (subType == -1) {
+		auto it = itemTypeCount.find(itemId);
+		return it != itemTypeCount.end() ? it->second : 0;
+	}
+
+	// the index does not track subtypes, but it tells us when there is nothing to look for
+	if (!itemTypeCount.contains(itemId)) {
+		return 0;
+	}
+
 	uint32_t count = 0;
 	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
 		Item* item = inventory[i];
@@ -2789,6 +2875,11 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 		return true;
 	}
 
+	// equipped items are included in the index, so it is only an upper bound when they are ignored
+	if (getItemTypeCount(itemId, subType) < amount) {
+		return false;
+	}
+
 	std::vector<Item*> itemList;
 
 	uint32_t count = 0;
@@ -2835,21 +2926,76 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 }
 
 std::map<uint32_t, uint32_t>& Player::getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const {
+	assert(checkItemTypeIndex());
+
+	for (const auto& [itemId, count] : itemTypeCount) {
+		countMap[itemId] += count;
+	}
+	return countMap;
+}
+
+void Player::addItemTypeCount(const Item* item) {
+	updateItemTypeCount(item->getID(), item->getItemCount());
+
+	if (const Container* container = item->getContainer()) {
+		for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+			updateItemTypeCount((*it)->getID(), (*it)->getItemCount());
+		}
+	}
+}
+
+void Player::removeItemTypeCount(const Item* item) {
+	updateItemTypeCount(item->getID(), -static_cast<int32_t>(item->getItemCount()));
+
+	if (const Container* container = item->getContainer()) {
+		for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+			updateItemTypeCount((*it)->getID(), -static_cast<int32_t>((*it)->getItemCount()));
+		}
+	}
+}
+
+void Player::updateItemTypeCount(uint16_t itemId, int32_t diff) {
+	if (diff == 0) {
+		return;
+	}
+
+	auto it = itemTypeCount.find(itemId);
+	if (it == itemTypeCount.end()) {
+		assert(diff > 0);
+		itemTypeCount.emplace(itemId, diff);
+		return;
+	}
+
+	assert(diff > 0 || it->second >= static_cast<uint32_t>(-diff));
+	it->second += diff;
+	if (it->second == 0) {
+		itemTypeCount.erase(it);
+	}
+}
+
+bool Player::checkItemTypeIndex() const {
+	std::unordered_map<uint16_t, uint32_t> countMap;
 	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
 		Item* item = inventory[i];
 		if (!item) {
 			continue;
 		}
 
-		countMap[item->getID()] += Item::countByType(item, -1);
+		countMap[item->getID()] += item->getItemCount();
 
 		if (Container* container = item->getContainer()) {
 			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				countMap[(*it)->getID()] += Item::countByType(*it, -1);
+				countMap[(*it)->getID()] += (*it)->getItemCount();
 			}
 		}
 	}
-	return countMap;
+	std::erase_if(countMap, [](const auto& it) { return it.second == 0; });
+
+	if (countMap != itemTypeCount) {
+		std::cout << "[Warning - Player::checkItemTypeIndex] Item type index of " << name << " is out of sync." << std::endl;
+		return false;
+	}
+	return true;
 }
 
 Thing* Player::getThing(size_t index) const {
@@ -2881,7 +3027,7 @@ void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_
 			requireListUpdate = oldParent != this;
 		}
 
-		updateInventoryWeight();
+		assert(inventoryWeight == computeInventoryWeight());
 		updateItemsLight();
 		sendStats();
 	}
@@ -2935,7 +3081,7 @@ void Player::postRemoveNotification(Thing* thing, const Cylinder* newParent, int
 			requireListUpdate = newParent != this;
 		}
 
-		updateInventoryWeight();
+		assert(inventoryWeight == computeInventoryWeight());
 		updateItemsLight();
 		sendStats();
 	}
@@ -3035,6 +3181,8 @@ void Player::internalAddThing(uint32_t index, Thing* thing) {
 
 		inventory[index] = item;
 		item->setParent(this);
+		addInventoryWeight(item->getWeight());
+		addItemTypeCount(item);
 	}
 }
 
@@ -4288,33 +4436,13 @@ void Player::sendClosePrivate(uint16_t channelId) {
 }
 
 uint64_t Player::getMoney() const {
-	std::vector<const Container*> containers;
-	uint64_t moneyCount = 0;
-
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; ++i) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
-		}
-
-		const Container* container = item->getContainer();
-		if (container) {
-			containers.push_back(container);
-		} else {
-			moneyCount += item->getWorth();
-		}
-	}
+	assert(checkItemTypeIndex());
 
-	size_t i = 0;
-	while (i < containers.size()) {
-		const Container* container = containers[i++];
-		for (const Item* item : container->getItemList()) {
-			const Container* tmpContainer = item->getContainer();
-			if (tmpContainer) {
-				containers.push_back(tmpContainer);
-			} else {
-				moneyCount += item->getWorth();
-			}
+	uint64_t moneyCount = 0;
+	for (const auto& [worth, itemId] : Item::items.currencyItems) {
+		auto it = itemTypeCount.find(itemId);
+		if (it != itemTypeCount.end()) {
+			moneyCount += worth * it->second;
 		}
 	}
 	return moneyCount;
@@ -6,6 +6,7 @@
 
 #include "creature.h"
 #include "cylinder.h"
+#include "database.h"
 #include "depotchest.h"
 #include "depotlocker.h"
 #include "enums.h"
@@ -20,6 +21,7 @@ class House;
 class NetworkMessage;
 class Npc;
 class Party;
+class Quest;
 class SchedulerTask;
 
 struct Mount;
@@ -313,6 +315,9 @@ class Player final : public Creature, public Cylinder {
 
 		void setStorageValue(uint32_t key, std::optional<int32_t> value, bool isSpawn = false) override;
 
+		const std::vector<const Quest*>& getStartedQuests();
+		uint16_t getStartedMissionsCount(const Quest& quest);
+
 		void setGroup(Group* newGroup) {
 			group = newGroup;
 		}
@@ -445,6 +450,8 @@ class Player final : public Creature, public Cylinder {
 			return std::max<int32_t>(0, capacity - inventoryWeight);
 		}
 
+		void addInventoryWeight(int32_t diff);
+
 		int32_t getMaxHealth() const override {
 			return std::max<int32_t>(1, healthMax + varStats[STAT_MAXHITPOINTS]);
 		}
@@ -1179,6 +1186,15 @@ class Player final : public Creature, public Cylinder {
 		void removeExperience(uint64_t exp, bool sendText = false);
 
 		void updateInventoryWeight();
+		uint32_t computeInventoryWeight() const;
+
+		void updateQuestLogCache();
+
+		// index of the item types carried in the inventory slots, including nested containers
+		void addItemTypeCount(const Item* item);
+		void removeItemTypeCount(const Item* item);
+		void updateItemTypeCount(uint16_t itemId, int32_t diff);
+		bool checkItemTypeIndex() const;
 
 		void setNextWalkActionTask(SchedulerTask* task);
 		void setNextActionTask(SchedulerTask* task, bool resetIdleTime = true);
@@ -1220,11 +1236,20 @@ class Player final : public Creature, public Cylinder {
 		std::map<uint8_t, OpenContainer> openContainers;
 
 		std::map<uint16_t, uint8_t> outfits;
+		// per player table the key and hash of every row it holds, see IOLoginData::serializeRows
+		std::map<std::string_view, std::unordered_map<std::string, size_t>> savedRows;
+		// per item table the sid of every item written to it, see IOLoginData::serializeItems
+		std::map<std::string_view, std::unordered_map<const Item*, uint32_t>> itemSids;
+		std::unordered_map<uint16_t, uint32_t> itemTypeCount;
 		std::unordered_set<uint16_t> mounts;
 		GuildWarVector guildWarVector;
 
 		std::list<ShopInfo> shopItemList;
 
+		// quest log cache, rebuilt once the quests revision or a quest storage changes
+		std::vector<const Quest*> startedQuests;
+		std::unordered_map<uint16_t, uint16_t> startedMissionsCount;
+
 		std::forward_list<Party*> invitePartyList;
 		std::forward_list<uint32_t> modalWindows;
 		std::forward_list<std::string> learnedInstantSpellList;
@@ -1277,7 +1302,12 @@ class Player final : public Creature, public Cylinder {
 		std::map<uint32_t, DepotChest_ptr> depotChests;
 		std::map<uint32_t, DepotLocker_ptr> depotLockerMap;
 
+		// rows fetched at login, kept until the depot or inbox is first used
+		DBResult_ptr pendingDepotItems;
+		DBResult_ptr pendingInboxItems;
+
 		uint32_t inventoryWeight = 0;
+		uint32_t questLogRevision = 0;
 		uint32_t capacity = 40000;
 		uint32_t damageImmunities = 0;
 		uint32_t conditionImmunities = 0;
@@ -1379,6 +1409,7 @@ class Player final : public Creature, public Cylinder {
 		friend class Actions;
 		friend class IOLoginData;
 		friend class ProtocolGame;
+		friend class Container;
 };
 
 #endif // FS_PLAYER_H
\ No newline at end of file
@@ -121,99 +121,171 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 	//dispatcher thread
 	Player* foundPlayer = g_game.getPlayerByName(name);
 	if (!foundPlayer || getBoolean(ConfigManager::ALLOW_CLONES)) {
-		player = new Player(getThis());
-		player->setName(name);
+		loadPlayerData(name, accountId, operatingSystem);
+		return;
+	}
 
-		player->incrementReferenceCounter();
-		player->setID();
+	if (eventConnect != 0 || !getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
+		//Already trying to connect
+		disconnectClient("You are already logged in.");
+		return;
+	}
 
-		if (!IOLoginData::preloadPlayer(player, name)) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+	if (foundPlayer->client) {
+		foundPlayer->disconnect();
+		foundPlayer->isConnecting = true;
 
-		if (IOBan::isPlayerNamelocked(player->getGUID())) {
-			disconnectClient("Your character has been namelocked.");
-			return;
-		}
+		eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
+			thisPtr->connect(playerID, operatingSystem);
+		}));
+	} else {
+		connect(foundPlayer->getID(), operatingSystem);
+	}
 
-		if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("The game is just going down.\nPlease try again later.");
-			return;
-		}
+	net::insert_protocol_to_autosend(shared_from_this());
+}
 
-		if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("Server is currently closed.\nPlease try again later.");
-			return;
+void ProtocolGame::loadPlayerData(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem) {
+	//dispatcher thread
+	// only the rows deciding whether the character may log in, its items and storage are fetched once it is admitted
+	g_databaseTasks.addTask([=, thisPtr = getThis()](Database& db) {
+		auto data = std::make_shared<PlayerData>();
+		if (IOLoginData::fetchPlayerPreloadData(db, *data, name)) {
+			data->namelocked = IOBan::isPlayerNamelocked(db, data->player->getNumber<uint32_t>("id"));
+			data->banInfo = IOBan::getAccountBanInfo(db, accountId);
 		}
 
-		if (getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
-			disconnectClient("You may only login with one character\nof your account at the same time.");
-			return;
-		}
+		g_dispatcher.addTask([=]() {
+			thisPtr->onPlayerDataLoaded(name, accountId, operatingSystem, *data);
+		});
+	}, DATABASE_TASK_UNORDERED);
+}
 
-		if (!player->hasFlag(PlayerFlag_CannotBeBanned)) {
-			if (const auto& banInfo = IOBan::getAccountBanInfo(accountId)) {
-				if (banInfo->expiresAt > 0) {
-					disconnectClient(fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
-				} else {
-					disconnectClient(fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}", banInfo->bannedBy, banInfo->reason));
-				}
-				return;
-			}
-		}
+void ProtocolGame::onPlayerDataLoaded(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem, const PlayerData& data) {
+	//dispatcher thread
+	if (isConnectionExpired()) {
+		return;
+	}
 
-		if (std::size_t currentSlot = clientLogin(*player)) {
-			uint8_t retryTime = getWaitTime(currentSlot);
-			auto output = net::make_output_message();
-			output->addByte(0x16);
-			output->addString(fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
-			output->addByte(retryTime);
-			send(output);
-			disconnect();
-			return;
-		}
+	// the character logged in meanwhile
+	if (!getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByName(name)) {
+		login(name, accountId, operatingSystem);
+		return;
+	}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID())) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+	player = new Player(getThis());
+	player->setName(name);
 
-		player->setOperatingSystem(operatingSystem);
+	player->incrementReferenceCounter();
+	player->setID();
 
-		if (!g_game.placeCreature(player, player->getLoginPosition())) {
-			if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
-				disconnectClient("Temple position is wrong. Contact the administrator.");
-				return;
-			}
-		}
+	if (!IOLoginData::preloadPlayer(player, data)) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
 
-		if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
-			player->registerCreatureEvent("ExtendedOpcode");
-		}
+	if (data.namelocked) {
+		disconnectClient("Your character has been namelocked.");
+		return;
+	}
 
-		player->lastIP = player->getIP();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
-	} else {
-		if (eventConnect != 0 || !getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
-			//Already trying to connect
-			disconnectClient("You are already logged in.");
+	if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return;
+	}
+
+	if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("Server is currently closed.\nPlease try again later.");
+		return;
+	}
+
+	if (getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
+		disconnectClient("You may only login with one character\nof your account at the same time.");
+		return;
+	}
+
+	if (!player->hasFlag(PlayerFlag_CannotBeBanned)) {
+		if (const auto& banInfo = data.banInfo) {
+			if (banInfo->expiresAt > 0) {
+				disconnectClient(fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
+			} else {
+				disconnectClient(fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}", banInfo->bannedBy, banInfo->reason));
+			}
 			return;
 		}
+	}
 
-		if (foundPlayer->client) {
-			foundPlayer->disconnect();
-			foundPlayer->isConnecting = true;
+	if (std::size_t currentSlot = clientLogin(*player)) {
+		uint8_t retryTime = getWaitTime(currentSlot);
+		auto output = net::make_output_message();
+		output->addByte(0x16);
+		output->addString(fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
+		output->addByte(retryTime);
+		send(output);
+		disconnect();
+		return;
+	}
 
-			eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
-				thisPtr->connect(playerID, operatingSystem);
-			}));
-		} else {
-			connect(foundPlayer->getID(), operatingSystem);
+	loadPlayerDetails(operatingSystem);
+}
+
+void ProtocolGame::loadPlayerDetails(OperatingSystem_t operatingSystem) {
+	//dispatcher thread
+	// queued behind the saves of the character, so the rows are not older than its last asynchronous save
+	const uint32_t guid = player->getGUID();
+	g_databaseTasks.addTask([=, thisPtr = getThis(), playerSaveSequence = g_game.startPlayerLoad()](Database& db) {
+		auto data = std::make_shared<PlayerData>();
+		IOLoginData::fetchPlayerDataById(db, *data, guid);
+
+		g_dispatcher.addTask([=]() {
+			thisPtr->onPlayerDetailsLoaded(operatingSystem, guid, *data, playerSaveSequence);
+		});
+	}, getPlayerTaskKey(guid));
+}
+
+void ProtocolGame::onPlayerDetailsLoaded(OperatingSystem_t operatingSystem, uint32_t guid, const PlayerData& data, uint32_t playerSaveSequence) {
+	//dispatcher thread
+	// an offline save written on the dispatcher is not ordered with the fetch, it is forgotten once no fetch needs it
+	const bool saved = g_game.getLastOfflinePlayerSave(guid) > playerSaveSequence;
+	g_game.finishPlayerLoad(playerSaveSequence);
+
+	if (isConnectionExpired() || !player) {
+		return;
+	}
+
+	// the character logged in on another connection meanwhile
+	if (!getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByName(player->getName())) {
+		disconnectClient("You are already logged in.");
+		return;
+	}
+
+	if (saved) {
+		loadPlayerDetails(operatingSystem);
+		return;
+	}
+
+	if (!IOLoginData::loadPlayer(player, data)) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
+
+	player->setOperatingSystem(operatingSystem);
+
+	if (!g_game.placeCreature(player, player->getLoginPosition())) {
+		if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
+			disconnectClient("Temple position is wrong. Contact the administrator.");
+			return;
 		}
 	}
 
+	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	player->lastIP = player->getIP();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
 	net::insert_protocol_to_autosend(shared_from_this());
 }
 
@@ -376,20 +448,23 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg) {
 		return;
 	}
 
-	if (const auto& banInfo = IOBan::getIpBanInfo(getIP())) {
-		disconnectClient(fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
-		return;
-	}
+	// the ban check and the authentication run on a database worker instead of blocking the network thread
+	g_databaseTasks.addTask([=, thisPtr = getThis(), ip = getIP(), accountName = std::string{accountName}, password = std::string{password}, token = std::string{token}, characterName = std::string{characterName}](Database& db) {
+		if (const auto& banInfo = IOBan::getIpBanInfo(db, ip)) {
+			thisPtr->disconnectClient(fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
+			return;
+		}
 
-	auto[accountId, charName] = IOLoginData::gameworldAuthentication(accountName, password, characterName, token, tokenTime);
-	if (accountId == 0) {
-		disconnectClient("Account name or password is not correct.");
-		return;
-	}
+		auto[accountId, charName] = IOLoginData::gameworldAuthentication(db, accountName, password, characterName, token, tokenTime);
+		if (accountId == 0) {
+			thisPtr->disconnectClient("Account name or password is not correct.");
+			return;
+		}
 
-	g_dispatcher.addTask([=, thisPtr = getThis()]() {
-		thisPtr->login(charName, accountId, operatingSystem);
-	});
+		g_dispatcher.addTask([=]() {
+			thisPtr->login(charName, accountId, operatingSystem);
+		});
+	}, DATABASE_TASK_UNORDERED);
 }
 
 void ProtocolGame::onConnect() {
@@ -579,7 +654,7 @@ void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage& msg) {
 		}
 	}
 
-	const CreatureVector* creatures = tile->getCreatures();
+	const TileCreatureVector* creatures = tile->getCreatures();
 	if (creatures) {
 		for (auto it = creatures->rbegin(), end = creatures->rend(); it != end; ++it) {
 			const Creature* creature = (*it);
@@ -2077,14 +2152,13 @@ void ProtocolGame::sendMarketDetail(uint16_t itemId) {
 void ProtocolGame::sendQuestLog() {
 	NetworkMessage msg;
 	msg.addByte(0xF0);
-	msg.add<uint16_t>(g_game.quests.getQuestsCount(player));
+	const auto& startedQuests = player->getStartedQuests();
+	msg.add<uint16_t>(startedQuests.size());
 
-	for (const Quest& quest : g_game.quests.getQuests()) {
-		if (quest.isStarted(player)) {
-			msg.add<uint16_t>(quest.getID());
-			msg.addString(quest.getName());
-			msg.addByte(quest.isCompleted(player));
-		}
+	for (const Quest* quest : startedQuests) {
+		msg.add<uint16_t>(quest->getID());
+		msg.addString(quest->getName());
+		msg.addByte(quest->isCompleted(player));
 	}
 
 	writeToOutputBuffer(msg);
@@ -6,6 +6,7 @@
 
 #include "chat.h"
 #include "creature.h"
+#include "databasetasks.h"
 #include "protocol.h"
 #include "tasks.h"
 
@@ -17,6 +18,7 @@ class ProtocolGame;
 class Quest;
 class Tile;
 class TrackedQuest;
+struct PlayerData;
 
 using ProtocolGame_ptr = std::shared_ptr<ProtocolGame>;
 
@@ -60,6 +62,10 @@ class ProtocolGame final : public Protocol {
 			return std::static_pointer_cast<ProtocolGame>(shared_from_this());
 		}
 		void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
+		void loadPlayerData(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem);
+		void onPlayerDataLoaded(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem, const PlayerData& data);
+		void loadPlayerDetails(OperatingSystem_t operatingSystem);
+		void onPlayerDetailsLoaded(OperatingSystem_t operatingSystem, uint32_t guid, const PlayerData& data, uint32_t playerSaveSequence);
 		void disconnectClient(const std::string& message) const;
 		void writeToOutputBuffer(const NetworkMessage& msg);
 
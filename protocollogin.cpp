@@ -7,6 +7,7 @@
 
 #include "ban.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "iologindata.h"
 #include "outputmessage.h"
@@ -14,38 +15,6 @@
 
 extern Game g_game;
 
-namespace {
-
-	std::string decodeSecret(std::string_view secret) {
-		// simple base32 decoding
-		std::string key;
-		key.reserve(10);
-
-		uint32_t buffer = 0, left = 0;
-		for (const auto& ch : secret) {
-			buffer <<= 5;
-			if (ch >= 'A' && ch <= 'Z') {
-				buffer |= (ch & 0x1F) - 1;
-			} else if (ch >= '2' && ch <= '7') {
-				buffer |= ch - 24;
-			} else {
-				// if a key is broken, return empty and the comparison will always be false since the token must not be
-				// empty
-				return {};
-			}
-
-			left += 5;
-			if (left >= 8) {
-				left -= 8;
-				key.push_back(static_cast<char>(buffer >> left));
-			}
-		}
-
-		return key;
-	}
-
-} // namespace
-
 void ProtocolLogin::disconnectClient(const std::string& message, uint16_t version) {
 	auto output = net::make_output_message();
 
@@ -56,31 +25,16 @@ void ProtocolLogin::disconnectClient(const std::string& message, uint16_t versio
 	disconnect();
 }
 
-void ProtocolLogin::getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, UNHEX(`password`) AS `password`, `secret`, `premium_ends_at` FROM `accounts` WHERE `name` = {:s}", db.escapeString(accountName)));
-	if (!result) {
+void ProtocolLogin::getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version, const AccountLoginInfo& account) {
+	//dispatcher thread
+	if (transformToSHA1(password) != account.password) {
 		disconnectClient("Account name or password is not correct.", version);
 		return;
 	}
 
-	if (transformToSHA1(password) != result->getString("password")) {
-		disconnectClient("Account name or password is not correct.", version);
-		return;
-	}
-
-	auto id = result->getNumber<uint32_t>("id");
-	auto key = decodeSecret(result->getString("secret"));
-	auto premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
-
-	std::vector<std::string> characters = {};
-	result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `account_id` = {:d} AND `deletion` = 0 ORDER BY `name` ASC", id));
-	if (result) {
-		do {
-			characters.emplace_back(result->getString("name"));
-		} while (result->next());
-	}
+	const auto& key = account.secret;
+	const auto premiumEndsAt = account.premiumEndsAt;
+	const auto& characters = account.characters;
 
 	uint32_t ticks = time(nullptr) / AUTHENTICATOR_PERIOD;
 
@@ -217,11 +171,6 @@ void ProtocolLogin::onRecvFirstMessage(NetworkMessage& msg) {
 		return;
 	}
 
-	if (const auto& banInfo = IOBan::getIpBanInfo(connection->getIP())) {
-		disconnectClient(fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason), version);
-		return;
-	}
-
 	auto accountName = msg.getString();
 	if (accountName.empty()) {
 		disconnectClient("Invalid account name.", version);
@@ -243,7 +192,21 @@ void ProtocolLogin::onRecvFirstMessage(NetworkMessage& msg) {
 
 	auto authToken = msg.getString();
 
-	g_dispatcher.addTask([=, thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this()), accountName = std::string{accountName}, password = std::string{password}, authToken = std::string{authToken}]() {
-		thisPtr->getCharacterList(accountName, password, authToken, version);
-	});
+	// the ban check and the account are read on a database worker, the character list is built on the dispatcher
+	g_databaseTasks.addTask([=, thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this()), ip = connection->getIP(), accountName = std::string{accountName}, password = std::string{password}, authToken = std::string{authToken}](Database& db) {
+		if (const auto& banInfo = IOBan::getIpBanInfo(db, ip)) {
+			thisPtr->disconnectClient(fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason), version);
+			return;
+		}
+
+		AccountLoginInfo_ptr account = IOLoginData::getAccountLoginInfo(db, accountName);
+		if (!account) {
+			thisPtr->disconnectClient("Account name or password is not correct.", version);
+			return;
+		}
+
+		g_dispatcher.addTask([=]() {
+			thisPtr->getCharacterList(accountName, password, authToken, version, *account);
+		});
+	}, DATABASE_TASK_UNORDERED);
 }
\ No newline at end of file
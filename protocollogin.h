@@ -7,6 +7,7 @@
 #include "protocol.h"
 
 class NetworkMessage;
+struct AccountLoginInfo;
 
 class ProtocolLogin : public Protocol {
 	public:
@@ -25,7 +26,7 @@ class ProtocolLogin : public Protocol {
 	private:
 		void disconnectClient(const std::string& message, uint16_t version);
 
-		void getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version);
+		void getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version, const AccountLoginInfo& account);
 };
 
 #endif // FS_PROTOCOLLOGIN_H
\ No newline at end of file
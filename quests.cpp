@@ -94,13 +94,7 @@ std::string Mission::getName(Player* player) const {
 }
 
 uint16_t Quest::getMissionsCount(Player* player) const {
-	uint16_t count = 0;
-	for (const Mission& mission : missions) {
-		if (mission.isStarted(player)) {
-			count++;
-		}
-	}
-	return count;
+	return player->getStartedMissionsCount(*this);
 }
 
 bool Quest::isCompleted(Player* player) const {
@@ -133,7 +127,14 @@ bool Quest::isStarted(Player* player) const {
 
 bool Quests::reload() {
 	quests.clear();
-	return loadFromXml();
+	storageIndex.clear();
+
+	// the lists are gone even if the file fails to load, the caches must not point into them
+	bool loaded = loadFromXml();
+	if (!loaded) {
+		++revision;
+	}
+	return loaded;
 }
 
 bool Quests::loadFromXml() {
@@ -176,6 +177,15 @@ bool Quests::loadFromXml() {
 			}
 		}
 	}
+
+	for (const Quest& quest : quests) {
+		storageIndex[quest.getStartStorageId()].emplace_back(&quest, nullptr);
+		for (const Mission& mission : quest.getMissions()) {
+			storageIndex[mission.getStorageId()].emplace_back(&quest, &mission);
+		}
+	}
+
+	++revision;
 	return true;
 }
 
@@ -189,25 +199,22 @@ Quest* Quests::getQuestByID(uint16_t id) {
 }
 
 uint16_t Quests::getQuestsCount(Player* player) const {
-	uint16_t count = 0;
-	for (const Quest& quest : quests) {
-		if (quest.isStarted(player)) {
-			count++;
-		}
-	}
-	return count;
+	return player->getStartedQuests().size();
 }
 
 bool Quests::isQuestStorage(const uint32_t key, const int32_t value, const int32_t oldValue) const {
-	for (const Quest& quest : quests) {
-		if (quest.getStartStorageId() == key && quest.getStartStorageValue() == value) {
-			return true;
-		}
+	auto it = storageIndex.find(key);
+	if (it == storageIndex.end()) {
+		return false;
+	}
 
-		for (const Mission& mission : quest.getMissions()) {
-			if (mission.getStorageId() == key && value >= mission.getStartStorageValue() && value <= mission.getEndStorageValue()) {
-				return mission.mainDescription.empty() || oldValue < mission.getStartStorageValue() || oldValue > mission.getEndStorageValue();
+	for (const auto& [quest, mission] : it->second) {
+		if (!mission) {
+			if (quest->getStartStorageValue() == value) {
+				return true;
 			}
+		} else if (value >= mission->getStartStorageValue() && value <= mission->getEndStorageValue()) {
+			return mission->mainDescription.empty() || oldValue < mission->getStartStorageValue() || oldValue > mission->getEndStorageValue();
 		}
 	}
 	return false;
@@ -90,11 +90,29 @@ class Quests {
 		bool loadFromXml();
 		Quest* getQuestByID(uint16_t id);
 		bool isQuestStorage(const uint32_t key, const int32_t value, const int32_t oldValue) const;
+		bool isQuestStorageKey(const uint32_t key) const {
+			return storageIndex.contains(key);
+		}
 		uint16_t getQuestsCount(Player* player) const;
 		bool reload();
 
+		uint32_t getRevision() const {
+			return revision;
+		}
+
 	private:
+		struct QuestStorage {
+			const Quest* quest;
+			const Mission* mission; // nullptr for the quest start storage
+		};
+
 		QuestsList quests;
+
+		// storage key -> quests/missions using it, in load order
+		std::unordered_map<uint32_t, std::vector<QuestStorage>> storageIndex;
+
+		// bumped on every load, invalidates the players' quest log caches
+		uint32_t revision = 0;
 };
 
 #endif // FS_QUESTS_H
\ No newline at end of file
@@ -0,0 +1,282 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SLAB_H
+#define FS_SLAB_H
+
+struct SlabStats {
+	uint64_t slabs = 0;
+	uint64_t releasedSlabs = 0;
+	uint64_t allocations = 0;
+	uint64_t deallocations = 0;
+	uint64_t largeAllocations = 0;
+	size_t freeBytes = 0;
+};
+
+/*
+* objects of one class hierarchy are carved from slabs with a size class per 16 bytes,
+* a freed block goes back to the free list of its own slab and is kept for the next object of the same size class
+* a slab none of whose blocks are in use goes back to the heap, only one empty slab per size class is kept for reuse
+* so a dropped map region or a crowd of players that logged out gives its memory back
+*/
+template <typename T>
+class SlabAllocator {
+	public:
+		static constexpr size_t SLAB_SIZE = 64 * 1024;
+		static constexpr size_t GRANULARITY = alignof(std::max_align_t);
+		static constexpr size_t SIZE_CLASSES = 32;
+
+		static void* allocate(size_t size) {
+			const size_t sizeClass = getSizeClass(size);
+			if (sizeClass >= SIZE_CLASSES) {
+				largeAllocations.fetch_add(1, std::memory_order_relaxed);
+				return ::operator new(size);
+			}
+
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			if (Arena* arena = currentArena) {
+				return arena->take(sizeClass);
+			}
+
+			std::lock_guard<std::mutex> lockClass(lock);
+			SizeClass& freeSlabs = sizeClasses[sizeClass];
+			Slab* slab = freeSlabs.head;
+			if (!slab) {
+				slab = createSlab(sizeClass, false);
+				freeSlabs.link(slab);
+			} else if (slab == freeSlabs.spare) {
+				freeSlabs.spare = nullptr;
+			}
+
+			void* block = slab->take();
+			if (!slab->hasRoom()) {
+				freeSlabs.unlink(slab);
+			}
+			return block;
+		}
+
+		static void deallocate(void* p, size_t size) noexcept {
+			const size_t sizeClass = getSizeClass(size);
+			if (sizeClass >= SIZE_CLASSES) {
+				::operator delete(p);
+				return;
+			}
+
+			deallocations.fetch_add(1, std::memory_order_relaxed);
+			std::lock_guard<std::mutex> lockClass(lock);
+			Slab* slab = Slab::of(p);
+			slab->freeBlocks = new (p) FreeBlock{slab->freeBlocks};
+			++slab->freeCount;
+			++sizeClasses[sizeClass].freeCount;
+			if (slab->used.fetch_sub(1, std::memory_order_relaxed) == 1) {
+				releaseEmptySlab(slab);
+			} else if (!slab->owned && !slab->linked) {
+				sizeClasses[sizeClass].link(slab);
+			}
+		}
+
+		static SlabStats getStats() {
+			SlabStats stats;
+			stats.slabs = slabs.load(std::memory_order_relaxed);
+			stats.releasedSlabs = releasedSlabs.load(std::memory_order_relaxed);
+			stats.allocations = allocations.load(std::memory_order_relaxed);
+			stats.deallocations = deallocations.load(std::memory_order_relaxed);
+			stats.largeAllocations = largeAllocations.load(std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> lockClass(lock);
+			for (size_t sizeClass = 0; sizeClass < SIZE_CLASSES; ++sizeClass) {
+				stats.freeBytes += sizeClasses[sizeClass].freeCount * getBlockSize(sizeClass);
+			}
+			return stats;
+		}
+
+	private:
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		// the header at the start of every slab, found from a block by rounding its address down
+		struct Slab {
+			FreeBlock* freeBlocks = nullptr;
+			Slab* prev = nullptr;
+			Slab* next = nullptr;
+			// the part of the slab no block was carved from yet
+			char* unused = nullptr;
+			char* end = nullptr;
+			size_t sizeClass = 0;
+			size_t freeCount = 0;
+			std::atomic<uint32_t> used = 0;
+			// taken by an arena, only that thread carves from it and it is neither listed nor released
+			bool owned = false;
+			bool linked = false;
+
+			static Slab* of(void* p) {
+				return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(p) & ~(SLAB_SIZE - 1));
+			}
+
+			bool hasRoom() const {
+				return freeBlocks || static_cast<size_t>(end - unused) >= getBlockSize(sizeClass);
+			}
+
+			void* take() {
+				used.fetch_add(1, std::memory_order_relaxed);
+				if (FreeBlock* block = freeBlocks) {
+					freeBlocks = block->next;
+					--freeCount;
+					--sizeClasses[sizeClass].freeCount;
+					return block;
+				}
+
+				void* block = unused;
+				unused += getBlockSize(sizeClass);
+				return block;
+			}
+		};
+
+		// the slabs of a size class with room that no arena owns
+		struct SizeClass {
+			Slab* head = nullptr;
+			// an empty slab kept to not go to the heap for every object when the count hovers around a slab boundary
+			Slab* spare = nullptr;
+			size_t freeCount = 0;
+
+			void link(Slab* slab) {
+				slab->prev = nullptr;
+				slab->next = head;
+				if (head) {
+					head->prev = slab;
+				}
+				head = slab;
+				slab->linked = true;
+			}
+
+			void unlink(Slab* slab) {
+				if (slab->prev) {
+					slab->prev->next = slab->next;
+				} else {
+					head = slab->next;
+				}
+				if (slab->next) {
+					slab->next->prev = slab->prev;
+				}
+				slab->linked = false;
+			}
+		};
+
+	public:
+		// while one is alive the thread carves blocks from slabs of its own without locking, e.g. a map loading thread
+		class Arena {
+			public:
+				Arena() : previous(currentArena) {
+					currentArena = this;
+				}
+
+				~Arena() {
+					currentArena = previous;
+
+					// the slabs are shared from now on, with whatever room they have left
+					std::lock_guard<std::mutex> lockClass(lock);
+					for (Slab* slab : slabs) {
+						if (slab) {
+							disown(slab);
+						}
+					}
+				}
+
+				// non-copyable
+				Arena(const Arena&) = delete;
+				Arena& operator=(const Arena&) = delete;
+
+			private:
+				void* take(size_t sizeClass) {
+					Slab*& slab = slabs[sizeClass];
+					if (!slab || static_cast<size_t>(slab->end - slab->unused) < getBlockSize(sizeClass)) {
+						if (slab) {
+							std::lock_guard<std::mutex> lockClass(lock);
+							disown(slab);
+						}
+						slab = createSlab(sizeClass, true);
+					}
+
+					// blocks freed meanwhile stay on the free list of the slab until it is disowned
+					slab->used.fetch_add(1, std::memory_order_relaxed);
+					void* block = slab->unused;
+					slab->unused += getBlockSize(sizeClass);
+					return block;
+				}
+
+				std::array<Slab*, SIZE_CLASSES> slabs = {};
+				Arena* previous;
+
+				friend class SlabAllocator;
+		};
+
+	private:
+		static constexpr size_t getSizeClass(size_t size) {
+			return size == 0 ? 0 : (size - 1) / GRANULARITY;
+		}
+
+		static constexpr size_t getBlockSize(size_t sizeClass) {
+			return (sizeClass + 1) * GRANULARITY;
+		}
+
+		static Slab* createSlab(size_t sizeClass, bool owned) {
+			char* memory = static_cast<char*>(::operator new(SLAB_SIZE, std::align_val_t{SLAB_SIZE}));
+			Slab* slab = new (memory) Slab;
+			constexpr size_t headerSize = (sizeof(Slab) + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+			slab->unused = memory + headerSize;
+			slab->end = memory + SLAB_SIZE;
+			slab->sizeClass = sizeClass;
+			slab->owned = owned;
+			slabs.fetch_add(1, std::memory_order_relaxed);
+			return slab;
+		}
+
+		// called with the lock held
+		static void disown(Slab* slab) {
+			slab->owned = false;
+			if (slab->used.load(std::memory_order_relaxed) == 0) {
+				releaseEmptySlab(slab);
+			} else if (slab->hasRoom()) {
+				sizeClasses[slab->sizeClass].link(slab);
+			}
+		}
+
+		// called with the lock held
+		static void releaseEmptySlab(Slab* slab) {
+			if (slab->owned) {
+				return;
+			}
+
+			SizeClass& freeSlabs = sizeClasses[slab->sizeClass];
+			if (!freeSlabs.spare) {
+				freeSlabs.spare = slab;
+				if (!slab->linked) {
+					freeSlabs.link(slab);
+				}
+				return;
+			}
+
+			if (slab->linked) {
+				freeSlabs.unlink(slab);
+			}
+
+			freeSlabs.freeCount -= slab->freeCount;
+			slab->~Slab();
+			::operator delete(static_cast<void*>(slab), std::align_val_t{SLAB_SIZE});
+			slabs.fetch_sub(1, std::memory_order_relaxed);
+			releasedSlabs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		inline static std::mutex lock;
+		inline static std::array<SizeClass, SIZE_CLASSES> sizeClasses;
+		inline static thread_local Arena* currentArena = nullptr;
+
+		inline static std::atomic<uint64_t> slabs = 0;
+		inline static std::atomic<uint64_t> releasedSlabs = 0;
+		inline static std::atomic<uint64_t> allocations = 0;
+		inline static std::atomic<uint64_t> deallocations = 0;
+		inline static std::atomic<uint64_t> largeAllocations = 0;
+};
+
+#endif // FS_SLAB_H
\ No newline at end of file
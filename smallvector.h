@@ -0,0 +1,165 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SMALLVECTOR_H
+#define FS_SMALLVECTOR_H
+
+// a vector that keeps its first N values inside the object and only moves them to the heap when it grows past that
+template <typename T, size_t N>
+class SmallVector {
+	static_assert(std::is_trivially_copyable_v<T>, "values are moved with memcpy");
+
+	public:
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		SmallVector() = default;
+		~SmallVector() {
+			if (isSpilled()) {
+				delete[] heapValues;
+			}
+		}
+
+		SmallVector(const SmallVector& other) {
+			reserve(other.count);
+			std::memcpy(data(), other.data(), other.count * sizeof(T));
+			count = other.count;
+		}
+
+		SmallVector& operator=(const SmallVector& other) {
+			if (this != &other) {
+				count = 0;
+				reserve(other.count);
+				std::memcpy(data(), other.data(), other.count * sizeof(T));
+				count = other.count;
+			}
+			return *this;
+		}
+
+		T* data() {
+			return isSpilled() ? heapValues : inlineValues;
+		}
+		const T* data() const {
+			return isSpilled() ? heapValues : inlineValues;
+		}
+
+		iterator begin() {
+			return data();
+		}
+		const_iterator begin() const {
+			return data();
+		}
+		iterator end() {
+			return data() + count;
+		}
+		const_iterator end() const {
+			return data() + count;
+		}
+		reverse_iterator rbegin() {
+			return reverse_iterator(end());
+		}
+		const_reverse_iterator rbegin() const {
+			return const_reverse_iterator(end());
+		}
+		reverse_iterator rend() {
+			return reverse_iterator(begin());
+		}
+		const_reverse_iterator rend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		size_t size() const {
+			return count;
+		}
+		bool empty() const {
+			return count == 0;
+		}
+		// keeps the heap block, a tile that needed it once is likely to need it again
+		void clear() {
+			count = 0;
+		}
+
+		T& operator[](size_t index) {
+			return data()[index];
+		}
+		const T& operator[](size_t index) const {
+			return data()[index];
+		}
+		T& at(size_t index) {
+			if (index >= count) {
+				throw std::out_of_range("SmallVector::at");
+			}
+			return data()[index];
+		}
+		const T& at(size_t index) const {
+			if (index >= count) {
+				throw std::out_of_range("SmallVector::at");
+			}
+			return data()[index];
+		}
+
+		void push_back(T value) {
+			if (count == capacity) {
+				reserve(capacity * 2);
+			}
+			data()[count++] = value;
+		}
+
+		iterator insert(const_iterator pos, T value) {
+			const size_t index = pos - begin();
+			if (count == capacity) {
+				reserve(capacity * 2);
+			}
+
+			T* values = data();
+			std::memmove(values + index + 1, values + index, (count - index) * sizeof(T));
+			values[index] = value;
+			++count;
+			return values + index;
+		}
+
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			const size_t index = first - begin();
+			const size_t removed = last - first;
+
+			T* values = data();
+			std::memmove(values + index, values + index + removed, (count - index - removed) * sizeof(T));
+			count -= removed;
+			return values + index;
+		}
+
+		void reserve(size_t newCapacity) {
+			if (newCapacity <= capacity) {
+				return;
+			}
+
+			T* values = new T[newCapacity];
+			std::memcpy(values, data(), count * sizeof(T));
+			if (isSpilled()) {
+				delete[] heapValues;
+			}
+			heapValues = values;
+			capacity = newCapacity;
+		}
+
+	private:
+		bool isSpilled() const {
+			return capacity > N;
+		}
+
+		union {
+			T inlineValues[N];
+			T* heapValues;
+		};
+		uint32_t count = 0;
+		uint32_t capacity = N;
+};
+
+#endif // FS_SMALLVECTOR_H
\ No newline at end of file
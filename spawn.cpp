@@ -20,37 +20,100 @@ extern Game g_game;
 static constexpr int32_t MINSPAWN_INTERVAL = 10 * 1000; // 10 seconds to match RME
 static constexpr int32_t MAXSPAWN_INTERVAL = 24 * 60 * 60 * 1000; // 1 day
 
-bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
+std::optional<std::vector<SpawnRecord>> Spawns::parseSpawns(const std::string& filename) {
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file(filename.c_str());
 	if (!result) {
 		printXMLError("Error - Spawns::loadFromXml", filename, result);
-		return false;
+		return std::nullopt;
 	}
 
-	this->filename = filename;
-	loaded = true;
-
+	std::vector<SpawnRecord> spawns;
 	for (auto spawnNode : doc.child("spawns").children()) {
-		Position centerPos(
+		SpawnRecord& spawn = spawns.emplace_back();
+		spawn.centerPos = Position(
 			pugi::cast<uint16_t>(spawnNode.attribute("centerx").value()),
 			pugi::cast<uint16_t>(spawnNode.attribute("centery").value()),
 			pugi::cast<uint16_t>(spawnNode.attribute("centerz").value())
 		);
 
-		int32_t radius;
 		pugi::xml_attribute radiusAttribute = spawnNode.attribute("radius");
 		if (radiusAttribute) {
-			radius = pugi::cast<int32_t>(radiusAttribute.value());
-		} else {
-			radius = -1;
+			spawn.radius = pugi::cast<int32_t>(radiusAttribute.value());
+		}
+
+		spawn.empty = !spawnNode.first_child();
+
+		for (auto childNode : spawnNode.children()) {
+			SpawnEntryRecord entry;
+			if (caseInsensitiveEqual(childNode.name(), "monsters")) {
+				entry.type = SpawnEntryRecord::MONSTERS;
+				for (auto monsterNode : childNode.children()) {
+					++entry.childCount;
+
+					pugi::xml_attribute nameAttribute = monsterNode.attribute("name");
+					if (!nameAttribute) {
+						continue;
+					}
+
+					int32_t chance = -1;
+					pugi::xml_attribute chanceAttribute = monsterNode.attribute("chance");
+					if (chanceAttribute) {
+						chance = pugi::cast<uint16_t>(chanceAttribute.value());
+					}
+					entry.monsters.emplace_back(nameAttribute.as_string(), chance);
+				}
+			} else if (caseInsensitiveEqual(childNode.name(), "monster") || caseInsensitiveEqual(childNode.name(), "npc")) {
+				pugi::xml_attribute nameAttribute = childNode.attribute("name");
+				if (!nameAttribute) {
+					continue;
+				}
+
+				entry.type = caseInsensitiveEqual(childNode.name(), "npc") ? SpawnEntryRecord::NPC : SpawnEntryRecord::MONSTER;
+				entry.name = nameAttribute.as_string();
+
+				pugi::xml_attribute directionAttribute = childNode.attribute("direction");
+				if (directionAttribute) {
+					entry.direction = pugi::cast<uint16_t>(directionAttribute.value());
+				}
+			} else {
+				continue;
+			}
+
+			entry.x = pugi::cast<uint16_t>(childNode.attribute("x").value());
+			entry.y = pugi::cast<uint16_t>(childNode.attribute("y").value());
+			if (entry.type != SpawnEntryRecord::NPC) {
+				entry.interval = pugi::cast<int32_t>(childNode.attribute("spawntime").value()) * 1000;
+			}
+			spawn.entries.push_back(std::move(entry));
 		}
+	}
+	return spawns;
+}
+
+bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
+	std::optional<std::vector<SpawnRecord>> spawns = parseSpawns(filename);
+	if (!spawns) {
+		return false;
+	}
+
+	loadSpawns(filename, *spawns, isCalledByLua);
+	return true;
+}
+
+void Spawns::loadSpawns(const std::string& filename, const std::vector<SpawnRecord>& spawns, bool isCalledByLua) {
+	this->filename = filename;
+	loaded = true;
+
+	for (const SpawnRecord& record : spawns) {
+		const Position& centerPos = record.centerPos;
+		const int32_t radius = record.radius;
 
 		if (radius > 30) {
 			std::cout << "[Warning - Spawns::loadFromXml] Radius size bigger than 30 at position: " << centerPos << ", consider lowering it." << std::endl;
 		}
 
-		if (!spawnNode.first_child()) {
+		if (record.empty) {
 			std::cout << "[Warning - Spawns::loadFromXml] Empty spawn at position: " << centerPos << " with radius: " << radius << '.' << std::endl;
 			continue;
 		}
@@ -58,15 +121,10 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 		spawnList.emplace_front(centerPos, radius);
 		Spawn& spawn = spawnList.front();
 
-		for (auto childNode : spawnNode.children()) {
-			if (caseInsensitiveEqual(childNode.name(), "monsters")) {
-				Position pos(
-					centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
-					centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
-					centerPos.z
-				);
-
-				int32_t interval = pugi::cast<int32_t>(childNode.attribute("spawntime").value()) * 1000;
+		for (const SpawnEntryRecord& entry : record.entries) {
+			const Position pos(centerPos.x + entry.x, centerPos.y + entry.y, centerPos.z);
+			const int32_t interval = entry.interval;
+			if (entry.type == SpawnEntryRecord::MONSTERS) {
 				if (interval < MINSPAWN_INTERVAL) {
 					std::cout << "[Warning - Spawns::loadFromXml] " << pos << " spawntime can not be less than " << MINSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
 					continue;
@@ -75,8 +133,7 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 					continue;
 				}
 
-				size_t monstersCount = std::distance(childNode.children().begin(), childNode.children().end());
-				if (monstersCount == 0) {
+				if (entry.childCount == 0) {
 					std::cout << "[Warning - Spawns::loadFromXml] " << pos << " empty monsters set." << std::endl;
 					continue;
 				}
@@ -88,22 +145,16 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 				sb.interval = interval;
 				sb.lastSpawn = 0;
 
-				for (auto monsterNode : childNode.children()) {
-					pugi::xml_attribute nameAttribute = monsterNode.attribute("name");
-					if (!nameAttribute) {
-						continue;
-					}
-
-					MonsterType* mType = g_monsters.getMonsterType(nameAttribute.as_string());
+				for (const auto& [name, monsterChance] : entry.monsters) {
+					MonsterType* mType = g_monsters.getMonsterType(name);
 					if (!mType) {
-						std::cout << "[Warning - Spawn::loadFromXml] " << pos << " can not find " << nameAttribute.as_string() << std::endl;
+						std::cout << "[Warning - Spawn::loadFromXml] " << pos << " can not find " << name << std::endl;
 						continue;
 					}
 
-					uint16_t chance = 100 / monstersCount;
-					pugi::xml_attribute chanceAttribute = monsterNode.attribute("chance");
-					if (chanceAttribute) {
-						chance = pugi::cast<uint16_t>(chanceAttribute.value());
+					uint16_t chance = 100 / entry.childCount;
+					if (monsterChance != -1) {
+						chance = monsterChance;
 					}
 
 					if (chance + totalChance > 100) {
@@ -130,57 +181,28 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 				}
 
 				spawn.addBlock(sb);
-			} else if (caseInsensitiveEqual(childNode.name(), "monster")) {
-				pugi::xml_attribute nameAttribute = childNode.attribute("name");
-				if (!nameAttribute) {
-					continue;
-				}
-
-				Direction dir;
-
-				pugi::xml_attribute directionAttribute = childNode.attribute("direction");
-				if (directionAttribute) {
-					dir = static_cast<Direction>(pugi::cast<uint16_t>(directionAttribute.value()));
-				} else {
-					dir = DIRECTION_NORTH;
-				}
-
-				Position pos(
-					centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
-					centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
-					centerPos.z
-				);
-				int32_t interval = pugi::cast<int32_t>(childNode.attribute("spawntime").value()) * 1000;
+			} else if (entry.type == SpawnEntryRecord::MONSTER) {
+				Direction dir = entry.direction != -1 ? static_cast<Direction>(entry.direction) : DIRECTION_NORTH;
 				if (interval >= MINSPAWN_INTERVAL && interval <= MAXSPAWN_INTERVAL) {
-					spawn.addMonster(nameAttribute.as_string(), pos, dir, static_cast<uint32_t>(interval));
+					spawn.addMonster(entry.name, pos, dir, static_cast<uint32_t>(interval));
 				} else {
 					if (interval < MINSPAWN_INTERVAL) {
-						std::cout << "[Warning - Spawns::loadFromXml] " << nameAttribute.as_string() << ' ' << pos << " spawntime can not be less than " << MINSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
+						std::cout << "[Warning - Spawns::loadFromXml] " << entry.name << ' ' << pos << " spawntime can not be less than " << MINSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
 					} else {
-						std::cout << "[Warning - Spawns::loadFromXml] " << nameAttribute.as_string() << ' ' << pos << " spawntime can not be more than " << MAXSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
+						std::cout << "[Warning - Spawns::loadFromXml] " << entry.name << ' ' << pos << " spawntime can not be more than " << MAXSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
 					}
 				}
-			} else if (caseInsensitiveEqual(childNode.name(), "npc")) {
-				pugi::xml_attribute nameAttribute = childNode.attribute("name");
-				if (!nameAttribute) {
-					continue;
-				}
-
-				Npc* npc = Npc::createNpc(nameAttribute.as_string());
+			} else {
+				Npc* npc = Npc::createNpc(entry.name);
 				if (!npc) {
 					continue;
 				}
 
-				pugi::xml_attribute directionAttribute = childNode.attribute("direction");
-				if (directionAttribute) {
-					npc->setDirection(static_cast<Direction>(pugi::cast<uint16_t>(directionAttribute.value())));
+				if (entry.direction != -1) {
+					npc->setDirection(static_cast<Direction>(entry.direction));
 				}
 
-				npc->setMasterPos(Position(
-					centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
-					centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
-					centerPos.z
-				), radius);
+				npc->setMasterPos(pos, radius);
 				npcList.push_front(npc);
 			}
 		}
@@ -188,7 +210,6 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 			spawn.startup();
 		}
 	}
-	return true;
 }
 
 void Spawns::startup() {
@@ -62,11 +62,42 @@ class Spawn {
 		void checkSpawn();
 };
 
+// an entry of a spawn as written in the spawn file, nothing is looked up yet so it can be cached with the map
+struct SpawnEntryRecord {
+	enum Type : uint8_t {
+		MONSTERS,
+		MONSTER,
+		NPC,
+	};
+
+	std::string name;
+	// the named children of a monsters entry and their chance, -1 if it has none
+	std::vector<std::pair<std::string, int32_t>> monsters;
+	// all children of a monsters entry, the chance of a monster without one is shared out by it
+	uint32_t childCount = 0;
+	int32_t interval = 0;
+	// -1 if the entry has none
+	int32_t direction = -1;
+	uint16_t x = 0;
+	uint16_t y = 0;
+	Type type = MONSTER;
+};
+
+struct SpawnRecord {
+	std::vector<SpawnEntryRecord> entries;
+	Position centerPos;
+	int32_t radius = -1;
+	bool empty = false;
+};
+
 class Spawns {
 	public:
 		static bool isInZone(const Position& centerPos, int32_t radius, const Position& pos);
 
+		static std::optional<std::vector<SpawnRecord>> parseSpawns(const std::string& filename);
+
 		bool loadFromXml(const std::string& filename, bool isCalledByLua = false);
+		void loadSpawns(const std::string& filename, const std::vector<SpawnRecord>& spawns, bool isCalledByLua = false);
 		void startup();
 		void clear();
 
@@ -84,7 +84,7 @@ bool Tile::hasHeight(uint32_t n) const {
 }
 
 size_t Tile::getCreatureCount() const {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		return creatures->size();
 	}
 	return 0;
@@ -207,7 +207,7 @@ BedItem* Tile::getBedItem() const {
 }
 
 Creature* Tile::getTopCreature() const {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (!creatures->empty()) {
 			return *creatures->begin();
 		}
@@ -216,7 +216,7 @@ Creature* Tile::getTopCreature() const {
 }
 
 const Creature* Tile::getBottomCreature() const {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (!creatures->empty()) {
 			return *creatures->rbegin();
 		}
@@ -225,7 +225,7 @@ const Creature* Tile::getBottomCreature() const {
 }
 
 Creature* Tile::getTopVisibleCreature(const Creature* creature) const {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (creature) {
 			for (Creature* tileCreature : *creatures) {
 				if (creature->canSeeCreature(tileCreature)) {
@@ -247,7 +247,7 @@ Creature* Tile::getTopVisibleCreature(const Creature* creature) const {
 }
 
 const Creature* Tile::getBottomVisibleCreature(const Creature* creature) const {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (creature) {
 			for (auto it = creatures->rbegin(), end = creatures->rend(); it != end; ++it) {
 				if (creature->canSeeCreature(*it)) {
@@ -289,7 +289,7 @@ Item* Tile::getItemByTopOrder(int32_t topOrder) {
 	//3: doors etc
 	//4: creatures
 	if (TileItemVector* items = getItemList()) {
-		for (auto it = ItemVector::const_reverse_iterator(items->getEndTopItem()), end = ItemVector::const_reverse_iterator(items->getBeginTopItem()); it != end; ++it) {
+		for (auto it = TileItemVector::const_reverse_iterator(items->getEndTopItem()), end = TileItemVector::const_reverse_iterator(items->getBeginTopItem()); it != end; ++it) {
 			if (Item::items[(*it)->getID()].alwaysOnTopOrder == topOrder) {
 				return (*it);
 			}
@@ -306,14 +306,14 @@ Thing* Tile::getTopVisibleThing(const Creature* creature) {
 
 	TileItemVector* items = getItemList();
 	if (items) {
-		for (ItemVector::const_iterator it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
+		for (TileItemVector::const_iterator it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
 			const ItemType& iit = Item::items[(*it)->getID()];
 			if (!iit.lookThrough) {
 				return (*it);
 			}
 		}
 
-		for (auto it = ItemVector::const_reverse_iterator(items->getEndTopItem()), end = ItemVector::const_reverse_iterator(items->getBeginTopItem()); it != end; ++it) {
+		for (auto it = TileItemVector::const_reverse_iterator(items->getEndTopItem()), end = TileItemVector::const_reverse_iterator(items->getBeginTopItem()); it != end; ++it) {
 			const ItemType& iit = Item::items[(*it)->getID()];
 			if (!iit.lookThrough) {
 				return (*it);
@@ -325,6 +325,12 @@ Thing* Tile::getTopVisibleThing(const Creature* creature) {
 }
 
 void Tile::onAddTileItem(Item* item) {
+	if (House* house = getHouse()) {
+		house->onItemChange();
+	} else if (item->isLoadedFromMap()) {
+		g_game.map.setRegionChanged(getPosition());
+	}
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -360,6 +366,12 @@ void Tile::onAddTileItem(Item* item) {
 }
 
 void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newItem, const ItemType& newType) {
+	if (House* house = getHouse()) {
+		house->onItemChange();
+	} else if (oldItem->isLoadedFromMap()) {
+		g_game.map.setRegionChanged(getPosition());
+	}
+
 	if (newItem->hasProperty(CONST_PROP_MOVEABLE) || newItem->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -397,6 +409,12 @@ void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newIte
 }
 
 void Tile::onRemoveTileItem(const SpectatorVec& spectators, const std::vector<int32_t>& oldStackPosVector, Item* item) {
+	if (House* house = getHouse()) {
+		house->onItemChange();
+	} else if (item->isLoadedFromMap()) {
+		g_game.map.setRegionChanged(getPosition());
+	}
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -472,7 +490,7 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 				return RETURNVALUE_NOTPOSSIBLE;
 			}
 
-			const CreatureVector* creatures = getCreatures();
+			const TileCreatureVector* creatures = getCreatures();
 			if (monster->canPushCreatures() && !monster->isSummon()) {
 				if (creatures) {
 					for (Creature* tileCreature : *creatures) {
@@ -533,7 +551,7 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 			return RETURNVALUE_NOERROR;
 		}
 
-		const CreatureVector* creatures = getCreatures();
+		const TileCreatureVector* creatures = getCreatures();
 		if (const Player* player = creature->getPlayer()) {
 			if (creatures && !creatures->empty() && !hasBitSet(FLAG_IGNOREBLOCKCREATURE, flags) && !player->isAccessPlayer()) {
 				for (const Creature* tileCreature : *creatures) {
@@ -623,7 +641,7 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 			return RETURNVALUE_NOTPOSSIBLE;
 		}
 
-		const CreatureVector* creatures = getCreatures();
+		const TileCreatureVector* creatures = getCreatures();
 		if (creatures && !creatures->empty() && item->isBlocking() && !hasBitSet(FLAG_IGNOREBLOCKCREATURE, flags)) {
 			for (const Creature* tileCreature : *creatures) {
 				if (!tileCreature->isInGhostMode()) {
@@ -817,7 +835,7 @@ void Tile::addThing(int32_t, Thing* thing) {
 		}
 
 		creature->setParent(this);
-		CreatureVector* creatures = makeCreatures();
+		TileCreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
 	} else {
 		Item* item = thing->getItem();
@@ -852,7 +870,7 @@ void Tile::addThing(int32_t, Thing* thing) {
 		} else if (itemType.alwaysOnTop) {
 			if (itemType.isSplash() && items) {
 				//remove old splash if exists
-				for (ItemVector::const_iterator it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
+				for (TileItemVector::const_iterator it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
 					Item* oldSplash = *it;
 					if (!Item::items[oldSplash->getID()].isSplash()) {
 						continue;
@@ -890,7 +908,7 @@ void Tile::addThing(int32_t, Thing* thing) {
 			if (itemType.isMagicField()) {
 				//remove old field item if exists
 				if (items) {
-					for (ItemVector::const_iterator it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
+					for (TileItemVector::const_iterator it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
 						MagicField* oldField = (*it)->getMagicField();
 						if (oldField) {
 							if (oldField->isReplaceable()) {
@@ -976,7 +994,7 @@ void Tile::replaceThing(uint32_t index, Thing* thing) {
 		pos -= topItemSize;
 	}
 
-	CreatureVector* creatures = getCreatures();
+	TileCreatureVector* creatures = getCreatures();
 	if (creatures) {
 		if (!isInserted && pos < static_cast<int32_t>(creatures->size())) {
 			return /*RETURNVALUE_NOTPOSSIBLE*/;
@@ -1013,7 +1031,7 @@ void Tile::replaceThing(uint32_t index, Thing* thing) {
 void Tile::removeThing(Thing* thing, uint32_t count) {
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		CreatureVector* creatures = getCreatures();
+		TileCreatureVector* creatures = getCreatures();
 		if (creatures) {
 			auto it = std::find(creatures->begin(), creatures->end(), thing);
 			if (it != creatures->end()) {
@@ -1104,7 +1122,7 @@ void Tile::removeThing(Thing* thing, uint32_t count) {
 
 bool Tile::hasCreature(Creature* creature) const
 {
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		return std::find(creatures->begin(), creatures->end(), creature) != creatures->end();
 	}
 	return false;
@@ -1139,7 +1157,7 @@ int32_t Tile::getThingIndex(const Thing* thing) const {
 		}
 	}
 
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (thing->getCreature()) {
 			for (Creature* creature : *creatures) {
 				++n;
@@ -1179,7 +1197,7 @@ int32_t Tile::getClientIndexOfCreature(const Player* player, const Creature* cre
 		n += items->getTopItemCount();
 	}
 
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		for (auto it = creatures->rbegin(), end = creatures->rend(); it != end; ++it) {
 			const Creature* c = (*it);
 			if (c == creature) {
@@ -1219,7 +1237,7 @@ int32_t Tile::getStackposOfItem(const Player* player, const Item* item) const {
 		}
 	}
 
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		for (const Creature* creature : *creatures) {
 			if (player->canSeeCreature(creature)) {
 				if (++n >= MAX_STACKPOS) {
@@ -1284,7 +1302,7 @@ Thing* Tile::getThing(size_t index) const {
 		index -= topItemSize;
 	}
 
-	if (const CreatureVector* creatures = getCreatures()) {
+	if (const TileCreatureVector* creatures = getCreatures()) {
 		if (index < creatures->size()) {
 			return (*creatures)[index];
 		}
@@ -1391,7 +1409,7 @@ void Tile::internalAddThing(uint32_t, Thing* thing) {
 			g_game.map.clearPlayersSpectatorCache();
 		}
 
-		CreatureVector* creatures = makeCreatures();
+		TileCreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
 	} else {
 		Item* item = thing->getItem();
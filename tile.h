@@ -6,10 +6,13 @@
 
 #include "cylinder.h"
 #include "item.h"
+#include "slab.h"
+#include "smallvector.h"
 #include "tools.h"
 
 class BedItem;
 class Creature;
+class House;
 class MagicField;
 class Mailbox;
 class SpectatorVec;
@@ -19,6 +22,10 @@ class TrashHolder;
 using CreatureVector = std::vector<Creature*>;
 using ItemVector = std::vector<Item*>;
 
+// most tiles hold a few items besides the ground and at most one creature, those stay inside the tile
+using TileCreatureVector = SmallVector<Creature*, 1>;
+using TileItems = SmallVector<Item*, 3>;
+
 enum tileflags_t : uint32_t {
 	TILESTATE_NONE = 0,
 
@@ -58,24 +65,24 @@ enum ZoneType_t {
 	ZONE_NORMAL,
 };
 
-class TileItemVector : private ItemVector {
+class TileItemVector : private TileItems {
 	public:
-		using ItemVector::begin;
-		using ItemVector::end;
-		using ItemVector::rbegin;
-		using ItemVector::rend;
-		using ItemVector::size;
-		using ItemVector::clear;
-		using ItemVector::at;
-		using ItemVector::insert;
-		using ItemVector::erase;
-		using ItemVector::push_back;
-		using ItemVector::value_type;
-		using ItemVector::iterator;
-		using ItemVector::const_iterator;
-		using ItemVector::reverse_iterator;
-		using ItemVector::const_reverse_iterator;
-		using ItemVector::empty;
+		using TileItems::begin;
+		using TileItems::end;
+		using TileItems::rbegin;
+		using TileItems::rend;
+		using TileItems::size;
+		using TileItems::clear;
+		using TileItems::at;
+		using TileItems::insert;
+		using TileItems::erase;
+		using TileItems::push_back;
+		using TileItems::value_type;
+		using TileItems::iterator;
+		using TileItems::const_iterator;
+		using TileItems::reverse_iterator;
+		using TileItems::const_reverse_iterator;
+		using TileItems::empty;
 
 		iterator getBeginDownItem() {
 			return begin();
@@ -136,6 +143,14 @@ class Tile : public Cylinder {
 			delete ground;
 		};
 
+		static void* operator new(size_t size) {
+			return SlabAllocator<Tile>::allocate(size);
+		}
+
+		static void operator delete(void* p, size_t size) {
+			SlabAllocator<Tile>::deallocate(p, size);
+		}
+
 		// non-copyable
 		Tile(const Tile&) = delete;
 		Tile& operator=(const Tile&) = delete;
@@ -144,9 +159,9 @@ class Tile : public Cylinder {
 		virtual const TileItemVector* getItemList() const = 0;
 		virtual TileItemVector* makeItemList() = 0;
 
-		virtual CreatureVector* getCreatures() = 0;
-		virtual const CreatureVector* getCreatures() const = 0;
-		virtual CreatureVector* makeCreatures() = 0;
+		virtual TileCreatureVector* getCreatures() = 0;
+		virtual const TileCreatureVector* getCreatures() const = 0;
+		virtual TileCreatureVector* makeCreatures() = 0;
 
 		int32_t getThrowRange() const override final {
 			return 0;
@@ -155,6 +170,10 @@ class Tile : public Cylinder {
 			return false;
 		}
 
+		virtual House* getHouse() const {
+			return nullptr;
+		}
+
 		MagicField* getFieldItem() const;
 		Teleport* getTeleportItem() const;
 		TrashHolder* getTrashHolder() const;
@@ -285,7 +304,7 @@ class Tile : public Cylinder {
 class DynamicTile : public Tile {
 		// By allocating the vectors in-house, we avoid some memory fragmentation
 		TileItemVector items;
-		CreatureVector creatures;
+		TileCreatureVector creatures;
 
 	public:
 		DynamicTile(uint16_t x, uint16_t y, uint8_t z) : Tile(x, y, z) {}
@@ -309,32 +328,31 @@ class DynamicTile : public Tile {
 			return &items;
 		}
 
-		CreatureVector* getCreatures() override {
+		TileCreatureVector* getCreatures() override {
 			return &creatures;
 		}
-		const CreatureVector* getCreatures() const override {
+		const TileCreatureVector* getCreatures() const override {
 			return &creatures;
 		}
-		CreatureVector* makeCreatures() override {
+		TileCreatureVector* makeCreatures() override {
 			return &creatures;
 		}
 
 		using Tile::internalAddThing;
 };
 
-// For blocking tiles, where we very rarely actually have items
+// For blocking tiles, where we very rarely actually have creatures
 class StaticTile final : public Tile {
-	// We very rarely even need the vectors, so don't keep them in memory
-	std::unique_ptr<TileItemVector> items;
-	std::unique_ptr<CreatureVector> creatures;
+	// walls and the like are items too, a few of them fit in the tile itself
+	TileItemVector items;
+	// We very rarely even need the creatures, so don't keep them in memory
+	std::unique_ptr<TileCreatureVector> creatures;
 
 	public:
 		StaticTile(uint16_t x, uint16_t y, uint8_t z) : Tile(x, y, z) {}
 		~StaticTile() {
-			if (items) {
-				for (Item* item : *items) {
-					item->decrementReferenceCounter();
-				}
+			for (Item* item : items) {
+				item->decrementReferenceCounter();
 			}
 		}
 
@@ -343,27 +361,24 @@ class StaticTile final : public Tile {
 		StaticTile& operator=(const StaticTile&) = delete;
 
 		TileItemVector* getItemList() override {
-			return items.get();
+			return &items;
 		}
 		const TileItemVector* getItemList() const override {
-			return items.get();
+			return &items;
 		}
 		TileItemVector* makeItemList() override {
-			if (!items) {
-				items.reset(new TileItemVector);
-			}
-			return items.get();
+			return &items;
 		}
 
-		CreatureVector* getCreatures() override {
+		TileCreatureVector* getCreatures() override {
 			return creatures.get();
 		}
-		const CreatureVector* getCreatures() const override {
+		const TileCreatureVector* getCreatures() const override {
 			return creatures.get();
 		}
-		CreatureVector* makeCreatures() override {
+		TileCreatureVector* makeCreatures() override {
 			if (!creatures) {
-				creatures.reset(new CreatureVector);
+				creatures.reset(new TileCreatureVector);
 			}
 			return creatures.get();
 		}
@@ -8,6 +8,7 @@
 #include "configmanager.h"
 
 #include <chrono>
+#include <fstream>
 #include <fmt/chrono.h>
 #include <openssl/evp.h>
 
@@ -623,6 +624,52 @@ uint32_t adlerChecksum(const uint8_t* data, size_t length) {
 	return (b << 16) | a;
 }
 
+uint64_t hashContents(std::string_view contents) {
+	// eight bytes per step, each step a bijection so that any single change shows in the result
+	uint64_t hash = 0xcbf29ce484222325ULL ^ contents.size();
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= contents.size(); i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, contents.data() + i, sizeof(word));
+		hash = (hash ^ word) * 0x100000001b3ULL;
+		hash ^= hash >> 32;
+	}
+
+	for (; i < contents.size(); ++i) {
+		hash = (hash ^ static_cast<uint8_t>(contents[i])) * 0x100000001b3ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+std::optional<std::string> readFileContents(const std::filesystem::path& fileName) {
+	std::ifstream file{fileName, std::ios::binary};
+	if (!file) {
+		return std::nullopt;
+	}
+	return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+bool replaceFileContents(const std::filesystem::path& fileName, std::string_view contents) {
+	std::filesystem::path tmpFile = fileName;
+	tmpFile += ".tmp";
+	{
+		std::ofstream file{tmpFile, std::ios::binary | std::ios::trunc};
+		if (!file.write(contents.data(), contents.size())) {
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmpFile, fileName, ec);
+	return !ec;
+}
+
 std::string ucfirst(std::string str) {
 	for (char& i : str) {
 		if (i != ' ') {
@@ -53,6 +53,12 @@ std::string getSkillName(uint8_t skillid);
 
 uint32_t adlerChecksum(const uint8_t* data, size_t length);
 
+// the same for the same contents on every start, to tell whether a cache file still matches the files it was built from
+uint64_t hashContents(std::string_view contents);
+std::optional<std::string> readFileContents(const std::filesystem::path& fileName);
+// writes the file aside and renames it, a server killed while writing never leaves a truncated file behind
+bool replaceFileContents(const std::filesystem::path& fileName, std::string_view contents);
+
 std::string ucfirst(std::string str);
 std::string ucwords(std::string str);
 bool booleanString(std::string_view str);